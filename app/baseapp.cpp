@@ -1,7 +1,15 @@
 #include "baseapp.h"
 
+#include "../profiler/profiler.h"
+
 #include <SDL.h>
 
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
 namespace app {
 
 GameApp::~GameApp() = default;
@@ -9,51 +17,328 @@ GameApp::~GameApp() = default;
 void GameApp::Run() {
   Initialize();
 
-  Uint32 time = SDL_GetTicks();
+  frame_count_ = 0;
+  const Uint64 start = SDL_GetPerformanceCounter();
+  if (threaded_simulation_) {
+    RunThreaded();
+  } else {
+    RunSingleThreaded();
+  }
+
+  if (IsHeadless()) {
+    const double seconds =
+        static_cast<double>(SDL_GetPerformanceCounter() - start) /
+        SDL_GetPerformanceFrequency();
+    std::cout << frame_count_ << " frames in " << seconds << " s, "
+              << (seconds > 0 ? frame_count_ / seconds : 0) << " fps"
+              << std::endl;
+  }
+
+  auto& profiler = profiler::Profiler::GetInstance();
+  if (!profile_csv_.empty()) {
+    profiler.WriteCsv(profile_csv_);
+  }
+  if (!profile_trace_.empty()) {
+    profiler.WriteChromeTrace(profile_trace_);
+  }
+
+  Free();
+
+  render::FreeAllResources();
+}
+
+void GameApp::RunSingleThreaded() {
+  const Uint64 frequency = SDL_GetPerformanceFrequency();
+  const Uint64 tick = frequency / tick_rate_;
+  const float dt = 1.f / tick_rate_;
+
+  Uint64 time = SDL_GetPerformanceCounter();
+  Uint64 accumulator = 0;
+
+  auto& profiler = profiler::Profiler::GetInstance();
 
   for (bool exit = false; !exit && !is_over_;) {
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-      switch (event.type) {
-        case SDL_QUIT:
-          exit = true;
-          break;
-        case SDL_WINDOWEVENT:
-          if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-            OnWindowResized(event.window.data1, event.window.data2);
-          }
-          break;
+    profiler.BeginFrame();
+    const Uint64 frame_start = SDL_GetPerformanceCounter();
+    accumulator += frame_start - time;
+    time = frame_start;
+
+    {
+      PROFILE_SCOPE("Frame");
+      {
+        PROFILE_SCOPE("Input");
+        exit = !ProcessEvents();
+      }
+
+      {
+        PROFILE_SCOPE("Update");
+        Simulate(accumulator, tick, dt);
+      }
+
+      {
+        PROFILE_SCOPE("Render");
+        BeginRender();
+        Render(static_cast<float>(accumulator) / tick);
+        EndRender();
+      }
+
+      {
+        PROFILE_SCOPE("Present");
+        SDL_RenderPresent(render::GetRenderer());
       }
     }
 
-    Uint32 delta_time = SDL_GetTicks() - time;
-    time = SDL_GetTicks();    
+    {
+      PROFILE_SCOPE("Wait");
+      WaitForNextFrame(frame_start);
+    }
+    profiler.EndFrame();
+    exit = exit || !EndFrame();
+  }
+}
 
-    if (delta_time > 0) {
-      Update(delta_time);
+void GameApp::RunThreaded() {
+  std::atomic<bool> running{true};
+  std::exception_ptr simulation_error;
+  std::thread simulation([this, &running, &simulation_error] {
+    try {
+      SimulationLoop(running);
+    } catch (...) {
+      simulation_error = std::current_exception();
+      is_over_ = true;
     }
+  });
+
+  try {
+    RenderLoop();
+  } catch (...) {
+    // The simulation thread must be joined before it is destroyed.
+    running = false;
+    simulation.join();
+    throw;
+  }
+
+  running = false;
+  simulation.join();
+  if (simulation_error)
+    std::rethrow_exception(simulation_error);
+}
 
-    MouseState mouse;
-    mouse.buttons = SDL_GetMouseState(&mouse.x, &mouse.y);
-    ProcessInput(SDL_GetKeyboardState(nullptr), mouse);
+void GameApp::RenderLoop() {
+  const Uint64 tick = SDL_GetPerformanceFrequency() / tick_rate_;
+  auto& profiler = profiler::Profiler::GetInstance();
 
-    SDL_SetRenderDrawColor(render::GetRenderer(), 0, 0, 0, 255);
-    SDL_RenderClear(render::GetRenderer());
+  for (bool exit = false; !exit && !is_over_;) {
+    profiler.BeginFrame();
+    const Uint64 frame_start = SDL_GetPerformanceCounter();
 
-    Render();
+    {
+      PROFILE_SCOPE("Frame");
+      {
+        PROFILE_SCOPE("Input");
+        exit = !ProcessEvents();
+      }
 
-    SDL_RenderPresent(render::GetRenderer());
+      {
+        PROFILE_SCOPE("Render");
+        BeginRender();
+        if (const RenderSnapshot* snapshot = snapshots_.Acquire()) {
+          const Uint64 age = frame_start > snapshot->published_at
+                                 ? frame_start - snapshot->published_at
+                                 : 0;
+          DrawSnapshot(*snapshot,
+                       std::min(1.f, static_cast<float>(age) / tick));
+        }
+        EndRender();
+      }
 
-    SDL_Delay(1000 / 60);
+      {
+        PROFILE_SCOPE("Present");
+        SDL_RenderPresent(render::GetRenderer());
+      }
+    }
+
+    {
+      PROFILE_SCOPE("Wait");
+      WaitForNextFrame(frame_start);
+    }
+    profiler.EndFrame();
+    exit = exit || !EndFrame();
   }
+}
 
-  Free();
+void GameApp::SimulationLoop(const std::atomic<bool>& running) {
+  const Uint64 frequency = SDL_GetPerformanceFrequency();
+  const Uint64 tick = frequency / tick_rate_;
+  const float dt = 1.f / tick_rate_;
 
-  render::FreeAllResources();
+  Uint64 time = SDL_GetPerformanceCounter();
+  Uint64 accumulator = 0;
+
+  while (running && !is_over_) {
+    const Uint64 now = SDL_GetPerformanceCounter();
+    accumulator += now - time;
+    time = now;
+
+    if (accumulator >= tick) {
+      Simulate(accumulator, tick, dt);
+
+      RenderSnapshot& snapshot = snapshots_.BeginWrite();
+      snapshot.Clear();
+      WriteSnapshot(snapshot);
+      snapshot.published_at = SDL_GetPerformanceCounter();
+      snapshots_.Publish();
+    }
+
+    const Uint64 remaining_ms = (tick - accumulator % tick) * 1000 / frequency;
+    if (remaining_ms > 0) {
+      SDL_Delay(static_cast<Uint32>(remaining_ms));
+    }
+  }
+}
+
+bool GameApp::ProcessEvents() {
+  bool keep_running = true;
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
+      case SDL_QUIT:
+        keep_running = false;
+        break;
+      case SDL_WINDOWEVENT:
+        if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+          OnWindowResized(event.window.data1, event.window.data2);
+        }
+        break;
+      // Only the content of render targets is restored here.
+      // SDL_RENDER_DEVICE_RESET also loses every loaded texture, which the
+      // resource manager can't reload, so it isn't handled.
+      case SDL_RENDER_TARGETS_RESET:
+        background_layers_.Invalidate();
+        OnRenderTargetsReset();
+        break;
+    }
+  }
+
+  MouseState mouse;
+  mouse.buttons = SDL_GetMouseState(&mouse.x, &mouse.y);
+  ProcessInput(SDL_GetKeyboardState(nullptr), mouse);
+  return keep_running;
+}
+
+void GameApp::Simulate(Uint64& accumulator, Uint64 tick, float dt) {
+  for (int steps = 0; accumulator >= tick; ++steps) {
+    if (steps == max_catch_up_steps_) {
+      accumulator %= tick;
+      break;
+    }
+    Update(dt);
+    accumulator -= tick;
+  }
+}
+
+void GameApp::BeginRender() {
+  render::UpdateAsyncLoads();
+  SDL_Renderer* renderer = render::GetRenderer();
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+  SDL_RenderClear(renderer);
+  render::SetDrawLayer(0);
+
+  SDL_Rect viewport = {};
+  SDL_GetRendererOutputSize(renderer, &viewport.w, &viewport.h);
+  render::GetSpriteBatch().SetCullRect(&viewport);
+
+  if (!background_layers_.IsEmpty()) {
+    background_layers_.Draw();
+  }
+}
+
+void GameApp::EndRender() {
+  render::FlushSprites();
+
+  if (profiler_overlay_) {
+    profiler::DrawOverlay(0, 0);
+  }
+}
+
+void GameApp::DrawSnapshot(const RenderSnapshot& snapshot, float alpha) {
+  for (const auto& sprite : snapshot.sprites) {
+    render::SetDrawLayer(sprite.layer);
+    render::DrawImage(
+        sprite.texture,
+        static_cast<int>(sprite.prev_x + (sprite.x - sprite.prev_x) * alpha),
+        static_cast<int>(sprite.prev_y + (sprite.y - sprite.prev_y) * alpha),
+        sprite.w, sprite.h);
+  }
 }
 
 void GameApp::GameOver() {
   is_over_ = true;
 }
 
+void GameApp::SetTickRate(int ticks_per_second) {
+  if (ticks_per_second <= 0)
+    throw std::invalid_argument("Tick rate must be positive");
+  tick_rate_ = ticks_per_second;
+}
+
+void GameApp::SetFrameRateLimit(int frames_per_second) {
+  if (frames_per_second < 0)
+    throw std::invalid_argument("Frame rate limit can't be negative");
+  frame_rate_limit_ = frames_per_second;
+}
+
+void GameApp::SetFrameCountLimit(int frames) {
+  if (frames < 0)
+    throw std::invalid_argument("Frame count limit can't be negative");
+  frame_count_limit_ = frames;
+}
+
+void GameApp::SetMaxCatchUpSteps(int steps) {
+  if (steps <= 0)
+    throw std::invalid_argument("Max catch-up steps must be positive");
+  max_catch_up_steps_ = steps;
+}
+
+void GameApp::SetThreadedSimulation(bool enabled) {
+  threaded_simulation_ = enabled;
+}
+
+render::LayerCache& GameApp::GetBackgroundLayers() {
+  return background_layers_;
+}
+
+void GameApp::SetProfilerOverlay(bool enabled) {
+  profiler_overlay_ = enabled;
+}
+
+void GameApp::SetProfileOutput(const std::filesystem::path& csv,
+                               const std::filesystem::path& chrome_trace) {
+  profile_csv_ = csv;
+  profile_trace_ = chrome_trace;
+}
+
+bool GameApp::EndFrame() {
+  ++frame_count_;
+  return frame_count_limit_ == 0 || frame_count_ < frame_count_limit_;
+}
+
+void GameApp::WaitForNextFrame(Uint64 frame_start) const {
+  if (frame_rate_limit_ == 0 || IsHeadless())
+    return;
+
+  const Uint64 frequency = SDL_GetPerformanceFrequency();
+  const Uint64 deadline = frame_start + frequency / frame_rate_limit_;
+
+  // SDL_Delay may oversleep by a scheduler quantum, so sleep up to the last
+  // millisecond of the budget and spin the rest.
+  for (Uint64 now = SDL_GetPerformanceCounter(); now < deadline;
+       now = SDL_GetPerformanceCounter()) {
+    const Uint64 remaining_ms = (deadline - now) * 1000 / frequency;
+    if (remaining_ms > 1) {
+      SDL_Delay(static_cast<Uint32>(remaining_ms - 1));
+    }
+  }
+}
+
 }  // namespace app
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "../graphics/graphics.h"
+#include "../graphics/layer_cache.h"
+#include "render_snapshot.h"
+
+#include <atomic>
+#include <filesystem>
 
 namespace app {
 
@@ -18,15 +23,84 @@ class GameApp : public render::RenderWindow {
   void Run();
   void GameOver();
 
+  // Update() is called |ticks_per_second| times per second of real time with
+  // a constant step, independent of the frame rate.
+  void SetTickRate(int ticks_per_second);
+  // Frames are paced to |frames_per_second|, 0 runs the loop uncapped.
+  // Headless windows always run uncapped.
+  void SetFrameRateLimit(int frames_per_second);
+  // Run() returns after |frames| frames, 0 runs until the window closes.
+  void SetFrameCountLimit(int frames);
+  // Upper bound of Update() calls in one frame. When the simulation falls
+  // further behind, the backlog is dropped instead of growing every frame.
+  void SetMaxCatchUpSteps(int steps);
+
+  // Runs Update() on a separate simulation thread, overlapping it with
+  // rendering and presenting. After each batch of ticks the simulation
+  // thread fills a RenderSnapshot through WriteSnapshot() and the main thread
+  // draws the latest one with DrawSnapshot() instead of calling Render().
+  // ProcessInput() still runs on the main thread, so state it shares with
+  // Update() must be synchronized by the game.
+  void SetThreadedSimulation(bool enabled);
+
+  // Static layers drawn at the bottom of every frame from a cached
+  // composite, see render::LayerCache.
+  render::LayerCache& GetBackgroundLayers();
+
+  // Draws the frame timings of profiler::Profiler on top of every frame.
+  void SetProfilerOverlay(bool enabled);
+  // Timings of the last frames are written to these files when Run()
+  // returns. An empty path skips that output.
+  void SetProfileOutput(const std::filesystem::path& csv,
+                        const std::filesystem::path& chrome_trace = {});
+
  private:
   virtual void Initialize() {}
   virtual void Free() {}
-  virtual void Update(Uint32 millis ) {}
-  virtual void Render() {}
+  // |dt| is the fixed simulation step in seconds.
+  virtual void Update(float dt) {}
+  // |alpha| in [0, 1) is how far the current frame lies between the last
+  // simulated state and the next one, to interpolate rendered positions.
+  virtual void Render(float alpha) {}
+  // Threaded simulation only, see SetThreadedSimulation(). Called on the
+  // simulation thread with a cleared snapshot.
+  virtual void WriteSnapshot(RenderSnapshot& snapshot) {}
+  // Threaded simulation only. The default draws every sprite interpolated
+  // by |alpha| between its previous and current position.
+  virtual void DrawSnapshot(const RenderSnapshot& snapshot, float alpha);
   virtual void ProcessInput(const Uint8* keyboard, const MouseState& mouse) {}
   virtual void OnWindowResized(int width, int height) {}
+  // Render target textures lost their content, e.g. a GameField cache must be
+  // redrawn. The background layers are invalidated already.
+  virtual void OnRenderTargetsReset() {}
+
+  void RunSingleThreaded();
+  void RunThreaded();
+  // Main thread half of RunThreaded(): events, snapshot drawing and present.
+  void RenderLoop();
+  void SimulationLoop(const std::atomic<bool>& running);
+  // Polls window events and forwards input, false once the window closes.
+  bool ProcessEvents();
+  // Runs the Update() steps due in |accumulator|.
+  void Simulate(Uint64& accumulator, Uint64 tick, float dt);
+  void BeginRender();
+  void EndRender();
+  void WaitForNextFrame(Uint64 frame_start) const;
+  // Counts the frame, false once the frame count limit is reached.
+  bool EndFrame();
 
-  bool is_over_ = false;
+  std::atomic<bool> is_over_{false};
+  bool threaded_simulation_ = false;
+  SnapshotBuffer snapshots_;
+  render::LayerCache background_layers_;
+  int tick_rate_ = 60;
+  int frame_rate_limit_ = 60;
+  int max_catch_up_steps_ = 5;
+  int frame_count_limit_ = 0;
+  int frame_count_ = 0;
+  bool profiler_overlay_ = false;
+  std::filesystem::path profile_csv_;
+  std::filesystem::path profile_trace_;
 };
 
 }  // namespace app
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../graphics/texture_handle.h"
+
+#include <SDL.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace app {
+
+// What the main thread needs to draw one simulated state. Written by the
+// simulation thread and read-only once published.
+struct RenderSnapshot {
+  struct Sprite {
+    render::TextureHandle texture;
+    int layer = 0;
+    // Positions at the previous and at the snapshot tick.
+    float prev_x = 0;
+    float prev_y = 0;
+    float x = 0;
+    float y = 0;
+    // 0 draws the texture at its own size.
+    int w = 0;
+    int h = 0;
+  };
+
+  void Clear() { sprites.clear(); }
+
+  void AddSprite(render::TextureHandle texture,
+                 int layer,
+                 float prev_x,
+                 float prev_y,
+                 float x,
+                 float y,
+                 int w = 0,
+                 int h = 0) {
+    sprites.push_back({texture, layer, prev_x, prev_y, x, y, w, h});
+  }
+
+  std::vector<Sprite> sprites;
+  // SDL_GetPerformanceCounter() when the snapshot was published.
+  Uint64 published_at = 0;
+};
+
+// Lock-free triple buffer between one writer and one reader thread. The
+// writer always has a buffer to fill, the reader always gets the latest
+// complete snapshot, and neither waits for the other. Buffers keep their
+// storage, so a steady state doesn't allocate.
+class SnapshotBuffer {
+ public:
+  RenderSnapshot& BeginWrite() { return buffers_[write_]; }
+
+  void Publish() {
+    write_ = middle_.exchange(write_ | kFresh, std::memory_order_acq_rel) &
+             kIndexMask;
+  }
+
+  // Returns the newest published snapshot, nullptr before the first one.
+  const RenderSnapshot* Acquire() {
+    if (middle_.load(std::memory_order_acquire) & kFresh) {
+      read_ = middle_.exchange(read_, std::memory_order_acq_rel) & kIndexMask;
+      has_read_ = true;
+    }
+    return has_read_ ? &buffers_[read_] : nullptr;
+  }
+
+ private:
+  static constexpr std::uint8_t kIndexMask = 3;
+  static constexpr std::uint8_t kFresh = 4;
+
+  std::array<RenderSnapshot, 3> buffers_;
+  std::uint8_t write_ = 0;
+  std::atomic<std::uint8_t> middle_{1};
+  std::uint8_t read_ = 2;
+  bool has_read_ = false;
+};
+
+}  // namespace app
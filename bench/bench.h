@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace bench {
+
+// Keeps the compiler from optimizing away a computed value.
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+// Calls |body| |iterations| times after one warm-up call and prints the
+// time per iteration and the throughput of |items| processed per iteration.
+template <typename Body>
+double Run(const std::string& name,
+           std::size_t items,
+           int iterations,
+           Body&& body) {
+  body();
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const double seconds = elapsed.count() / iterations;
+  const double items_per_second = seconds > 0 ? items / seconds : 0;
+  std::printf("%-40s %12.1f ns/iter %14.0f items/s\n", name.c_str(),
+              seconds * 1e9, items_per_second);
+  return items_per_second;
+}
+
+}  // namespace bench
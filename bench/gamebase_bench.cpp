@@ -0,0 +1,227 @@
+#include "../composite/composite.h"
+#include "../graphics/animator.h"
+#include "../graphics/atlas.h"
+#include "../graphics/graphics.h"
+#include "../jobs/job_system.h"
+#include "../ztyp/ship_store.h"
+#include "../ztyp/ztyp.h"
+#include "bench.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kLookups = 1000000;
+constexpr std::size_t kShips = 100000;
+constexpr float kDt = 0.1f;
+constexpr int kTargetSize = 1024;
+
+// Set by CMake so the benchmark finds the images from any directory.
+#ifdef GAMEBASE_SOURCE_DIR
+const std::string kImageDir = GAMEBASE_SOURCE_DIR "/resources/images/";
+#else
+const std::string kImageDir = "resources/images/";
+#endif
+
+template <int>
+struct Component {
+  int value = 0;
+};
+
+void RunCompositeBenchmarks() {
+  composite::Composite<struct BenchTag> composite;
+  composite.SetObject(Component<0>{1});
+  composite.SetObject(Component<1>{2});
+  composite.SetObject(Component<2>{3});
+  composite.SetObject(Component<3>{4});
+
+  bench::Run("Composite::GetObject", kLookups, 20, [&] {
+    int sum = 0;
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      bench::DoNotOptimize(composite);
+      sum += composite.GetObject<Component<2>>()->value;
+    }
+    bench::DoNotOptimize(sum);
+  });
+  bench::Run("Composite::GetObject (missing)", kLookups, 20, [&] {
+    int found = 0;
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      bench::DoNotOptimize(composite);
+      found += composite.GetObject<Component<4>>() != nullptr;
+    }
+    bench::DoNotOptimize(found);
+  });
+}
+
+void RunAtlasBenchmarks() {
+  render::Atlas atlas;
+  std::vector<std::string> lines;
+  for (int i = 0; i < 8; ++i) {
+    lines.push_back("line" + std::to_string(i));
+    atlas.AddAnimationLine(lines.back()).SetFramesCount(8, true);
+  }
+
+  bench::Run("Atlas::GetAnimationLine", kLookups, 20, [&] {
+    int frames = 0;
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      frames += atlas.GetAnimationLine(lines[i % lines.size()]).frames_count;
+    }
+    bench::DoNotOptimize(frames);
+  });
+}
+
+void RunShipBenchmarks(jobs::JobSystem& jobs) {
+  std::vector<std::unique_ptr<zt::SpaceShip>> ships;
+  zt::ShipStore store;
+  store.Reserve(kShips);
+  for (std::size_t i = 0; i < kShips; ++i) {
+    const zt::Vector2d p{static_cast<float>(i % 800), 0};
+    const zt::Vector2d v{static_cast<float>(i % 3) - 1, 2};
+    if (i % 2) {
+      ships.push_back(std::make_unique<zt::SmallShip>("", p, v));
+      store.Add(zt::ShipType::kSmall, p, v);
+    } else {
+      ships.push_back(std::make_unique<zt::MotherShip>("", p, v));
+      store.Add(zt::ShipType::kMother, p, v);
+    }
+  }
+
+  zt::SpawnQueue spawns;
+  bench::Run("SpaceShip::Update (virtual)", kShips, 100, [&] {
+    for (auto& ship : ships) {
+      ship->Update(kDt, spawns);
+    }
+    bench::DoNotOptimize(ships.front()->GetPosition());
+  });
+  bench::Run("ShipStore::Update", kShips, 100, [&] {
+    store.Update(kDt);
+    bench::DoNotOptimize(store.Get(zt::ShipType::kSmall).x.front());
+  });
+  bench::Run("ShipStore::Update (jobs)", kShips, 100, [&] {
+    store.Update(kDt, &jobs);
+    bench::DoNotOptimize(store.Get(zt::ShipType::kSmall).x.front());
+  });
+}
+
+// Every SpamShip splits off another one each 10 time units, so the
+// population doubles every 100 ticks.
+void RunSpamGrowthBenchmark(jobs::JobSystem& jobs) {
+  constexpr int kTicks = 1200;
+  auto simulate = [&] {
+    zt::ShipStore store;
+    store.Add(zt::ShipType::kSpam, {400, 0}, {0, 0});
+    for (int tick = 0; tick < kTicks; ++tick) {
+      store.Update(kDt, &jobs);
+    }
+    return store.Size();
+  };
+
+  const std::size_t population = simulate();
+  std::printf("SpamShip growth: %zu ships after %d ticks\n", population,
+              kTicks);
+  bench::Run("SpamShip growth", population, 5,
+             [&] { bench::DoNotOptimize(simulate()); });
+}
+
+// Lookups and draws need a renderer, a headless one needs no display.
+void RunRenderBenchmarks(std::size_t sprite_count) {
+  render::RenderWindow window(kTargetSize, kTargetSize,
+                              render::RenderWindow::Mode::kHeadless);
+  SDL_Renderer* renderer = render::GetRenderer();
+
+  std::vector<std::string> names;
+  std::vector<render::TextureHandle> handles;
+  for (int i = 0; i < 64; ++i) {
+    names.push_back("sprite" + std::to_string(i));
+    handles.push_back(
+        render::LoadResource(kImageDir + "apple.png", names.back()));
+  }
+
+  bench::Run("GetTextureHandle(name)", kLookups, 20, [&] {
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      bench::DoNotOptimize(render::GetTextureHandle(names[i % names.size()]));
+    }
+  });
+  bench::Run("GetTexture(name)", kLookups, 20, [&] {
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      bench::DoNotOptimize(render::GetTexture(names[i % names.size()]));
+    }
+  });
+  bench::Run("GetTexture(handle)", kLookups, 20, [&] {
+    for (std::size_t i = 0; i < kLookups; ++i) {
+      bench::DoNotOptimize(render::GetTexture(handles[i % handles.size()]));
+    }
+  });
+
+  auto atlas = render::Atlas::Create(kImageDir + "gradient.png", "atlas");
+  atlas.AddAnimationLine("a").SetFramesCount(8, true);
+  atlas.AddAnimationLine("b").SetFramesCount(8);
+  render::BakeAtlas(atlas);
+  const render::AnimationHandle animation = render::GetAnimation("atlas", "a");
+
+  auto position = [](std::size_t i, int* x, int* y) {
+    *x = static_cast<int>(i * 37 % kTargetSize);
+    *y = static_cast<int>(i * 91 % kTargetSize);
+  };
+
+  const std::string label = std::to_string(sprite_count) + " sprites/frame";
+  bench::Run("Render " + label, sprite_count, 50, [&] {
+    SDL_RenderClear(renderer);
+    for (std::size_t i = 0; i < sprite_count; ++i) {
+      int x, y;
+      position(i, &x, &y);
+      render::DrawImage(handles[i % handles.size()], x, y);
+    }
+    render::FlushSprites();
+    SDL_RenderFlush(renderer);
+  });
+
+  render::Animator animator;
+  animator.Reserve(sprite_count);
+  std::vector<render::Animator::Id> ids;
+  for (std::size_t i = 0; i < sprite_count; ++i) {
+    ids.push_back(animator.Add(animation, 4.f + i % 8));
+  }
+  bench::Run("Render " + label + " (animated)", sprite_count, 50, [&] {
+    SDL_RenderClear(renderer);
+    animator.Update(1.f / 60);
+    for (std::size_t i = 0; i < sprite_count; ++i) {
+      int x, y;
+      position(i, &x, &y);
+      animator.Draw(ids[i], x, y, 32, 32);
+    }
+    render::FlushSprites();
+    SDL_RenderFlush(renderer);
+  });
+
+  render::FreeAllResources();
+}
+
+}  // namespace
+
+// Usage: gamebase_bench [thousands of sprites per rendered frame]
+#undef main
+int main(int argc, char* argv[]) {
+  const std::size_t sprite_count =
+      1000 * static_cast<std::size_t>(argc > 1 ? std::atoi(argv[1]) : 10);
+
+  jobs::JobSystem jobs;
+  RunCompositeBenchmarks();
+  RunAtlasBenchmarks();
+  RunShipBenchmarks(jobs);
+  RunSpamGrowthBenchmark(jobs);
+  try {
+    RunRenderBenchmarks(sprite_count);
+  } catch (std::exception& e) {
+    std::printf("Render benchmarks failed: %s (%s)\n", e.what(),
+                SDL_GetError());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "../ztyp/kinematics.h"
+#include "../ztyp/ztyp.h"
+#include "bench.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kShips = 100000;
+constexpr int kIterations = 200;
+constexpr float kDt = 0.1f;
+
+struct Positions {
+  explicit Positions(std::size_t count)
+      : x(count), y(count), vx(count), vy(count) {
+    for (std::size_t i = 0; i < count; ++i) {
+      x[i] = static_cast<float>(i % 800);
+      y[i] = static_cast<float>(i / 800);
+      vx[i] = static_cast<float>(i % 3) - 1;
+      vy[i] = 2;
+    }
+  }
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> vx;
+  std::vector<float> vy;
+};
+
+void RunVirtualCalls() {
+  std::vector<std::unique_ptr<zt::SpaceShip>> ships;
+  for (std::size_t i = 0; i < kShips; ++i) {
+    ships.push_back(std::make_unique<zt::SmallShip>(
+        "", zt::Vector2d{static_cast<float>(i % 800), 0},
+        zt::Vector2d{static_cast<float>(i % 3) - 1, 2}));
+  }
+
+  zt::SpawnQueue spawns;
+  bench::Run("SpaceShip::Update (virtual)", kShips, kIterations, [&] {
+    for (auto& ship : ships) {
+      ship->Update(kDt, spawns);
+    }
+    bench::DoNotOptimize(ships.front()->GetPosition());
+  });
+}
+
+template <typename Kernel>
+void RunKernel(const std::string& name, Kernel kernel) {
+  Positions p(kShips);
+  bench::Run(name, kShips, kIterations, [&] {
+    kernel(p.x.data(), p.y.data(), p.vx.data(), p.vy.data(), kShips, kDt);
+    bench::DoNotOptimize(p.x.front());
+  });
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%zu ships, dispatched backend: %s\n", kShips,
+              zt::GetKinematicsBackendName(zt::GetKinematicsBackend()));
+
+  RunVirtualCalls();
+  RunKernel("IntegrateScalar", zt::internal::IntegrateScalar);
+  if (zt::internal::IsKinematicsBackendSupported(zt::KinematicsBackend::kSse2))
+    RunKernel("IntegrateSse2", zt::internal::IntegrateSse2);
+  if (zt::internal::IsKinematicsBackendSupported(zt::KinematicsBackend::kAvx2))
+    RunKernel("IntegrateAvx2", zt::internal::IntegrateAvx2);
+  RunKernel("IntegratePositions", zt::IntegratePositions);
+  return 0;
+}
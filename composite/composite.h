@@ -1,83 +1,178 @@
 #pragma once
 
-#include <memory>
-#include <typeinfo>
-#include <unordered_map>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
+#include "type_index.h"
 
 namespace composite {
 
 namespace internal {
 
-struct HolderBase {
-  virtual ~HolderBase() = default;
-};
+constexpr std::size_t kInlineObjectSize = 3 * sizeof(void*);
 
+// Small objects live inside the slot, bigger ones get one heap allocation.
 template <typename Object>
-struct Holder final : public HolderBase {
-  explicit Holder(const Object& object) : object_(new Object(object)) {}
-  ~Holder() final = default;
+constexpr bool kStoredInline =
+    sizeof(Object) <= kInlineObjectSize &&
+    alignof(Object) <= alignof(std::max_align_t) &&
+    std::is_nothrow_move_constructible_v<Object>;
+
+// Type-erased storage for at most one object.
+class Slot {
+ public:
+  Slot() = default;
+  Slot(const Slot&) = delete;
+  Slot& operator=(const Slot&) = delete;
+
+  Slot(Slot&& o) noexcept { MoveFrom(o); }
+
+  Slot& operator=(Slot&& o) noexcept {
+    if (this != &o) {
+      Reset();
+      MoveFrom(o);
+    }
+    return *this;
+  }
+
+  ~Slot() { Reset(); }
+
+  template <typename Object, typename... Args>
+  Object& Emplace(Args&&... args) {
+    if constexpr (kStoredInline<Object>) {
+      if (object_) {
+        // |args| may refer to the current object, build before destroying it.
+        Object object(std::forward<Args>(args)...);
+        Reset();
+        object_ = new (storage_) Object(std::move(object));
+      } else {
+        object_ = new (storage_) Object(std::forward<Args>(args)...);
+      }
+    } else {
+      Object* object = new Object(std::forward<Args>(args)...);
+      Reset();
+      object_ = object;
+    }
+    ops_ = &kOps<Object>;
+    return *static_cast<Object*>(object_);
+  }
+
+  void Reset() {
+    if (object_) {
+      ops_->destroy(object_);
+      object_ = nullptr;
+    }
+  }
+
+  void* Get() const { return object_; }
+
+ private:
+  struct Ops {
+    void (*destroy)(void* object);
+    // nullptr for heap objects, which are moved by stealing the pointer.
+    void (*relocate)(void* from, void* to);
+  };
+
+  template <typename Object>
+  static void Destroy(void* object) {
+    if constexpr (kStoredInline<Object>) {
+      static_cast<Object*>(object)->~Object();
+    } else {
+      delete static_cast<Object*>(object);
+    }
+  }
 
-  const Object* GetObject() const { return object_.get(); }
+  template <typename Object>
+  static void Relocate(void* from, void* to) {
+    Object* object = static_cast<Object*>(from);
+    new (to) Object(std::move(*object));
+    object->~Object();
+  }
 
-  Object* GetObject() { return object_.get(); }
+  template <typename Object>
+  static constexpr Ops kOps = {
+      &Destroy<Object>, kStoredInline<Object> ? &Relocate<Object> : nullptr};
+
+  void MoveFrom(Slot& o) {
+    if (!o.object_)
+      return;
+    ops_ = o.ops_;
+    if (ops_->relocate) {
+      ops_->relocate(o.object_, storage_);
+      object_ = storage_;
+    } else {
+      object_ = o.object_;
+    }
+    o.object_ = nullptr;
+  }
 
-  std::unique_ptr<Object> object_;
+  alignas(std::max_align_t) unsigned char storage_[kInlineObjectSize];
+  void* object_ = nullptr;
+  const Ops* ops_ = nullptr;
 };
 
 }  // namespace internal
 
-template <typename T>
+// Holds at most one object of each type. Types are numbered per Composite<T>
+// by GetTypeIndex(), so a lookup is an index into a fixed array of
+// |kCapacity| slots. A Composite<T> family cannot store more than |kCapacity|
+// distinct object types; only EmplaceObject() numbers a type, so looking up
+// or removing other types doesn't count.
+//
+// Objects up to internal::kInlineObjectSize bytes are stored in the slot
+// itself, larger ones take a single heap allocation.
+template <typename T, std::size_t kCapacity = 8>
 class Composite {
  public:
+  // Constructs the object in place, replacing any object of the same type.
+  template <typename Object, typename... Args>
+  Object& EmplaceObject(Args&&... args) {
+    const TypeIndex index = GetTypeIndex<Object, Composite>();
+    if (index >= kCapacity)
+      throw std::length_error("Too many object types in composite");
+    return slots_[index].template Emplace<Object>(std::forward<Args>(args)...);
+  }
+
   template <typename Object>
-  void SetObject(const Object& obj) {
-    objects_[typeid(obj)] = std::make_unique<internal::Holder<Object>>(obj);
+  void SetObject(Object&& obj) {
+    EmplaceObject<std::decay_t<Object>>(std::forward<Object>(obj));
   }
 
   template <typename Object>
   void RemoveObject() {
-    objects_.erase(typeid(Object));
+    const TypeIndex index = FindIndex<Object>();
+    if (index < kCapacity)
+      slots_[index].Reset();
   }
 
   template <typename Object>
   Object* GetObject() {
-    auto fnd = objects_.find(typeid(Object));
-    if (fnd == objects_.end())
+    const TypeIndex index = FindIndex<Object>();
+    if (index >= kCapacity)
       return nullptr;
-    return dynamic_cast<internal::Holder<Object>*>(fnd->second.get())
-        ->GetObject();
+    return static_cast<Object*>(slots_[index].Get());
   }
 
   template <typename Object>
   const Object* GetObject() const {
-    auto fnd = objects_.find(typeid(Object));
-    if (fnd == objects_.end())
+    const TypeIndex index = FindIndex<Object>();
+    if (index >= kCapacity)
       return nullptr;
-    return dynamic_cast<internal::Holder<Object>*>(fnd->second.get())
-        ->GetObject();
+    return static_cast<const Object*>(slots_[index].Get());
   }
 
  private:
-  using TypeInfoRef = std::reference_wrapper<const std::type_info>;
-
-  struct Hasher {
-    std::size_t operator()(TypeInfoRef code) const {
-      return code.get().hash_code();
-    }
-  };
-
-  struct EqualTo {
-    bool operator()(TypeInfoRef lhs, TypeInfoRef rhs) const {
-      return lhs.get() == rhs.get();
-    }
-  };
+  // kNoTypeIndex, which is past every slot, for types never emplaced.
+  template <typename Object>
+  static TypeIndex FindIndex() {
+    return FindTypeIndex<Object, Composite>();
+  }
 
-  std::unordered_map<TypeInfoRef,
-                     std::unique_ptr<internal::HolderBase>,
-                     Hasher,
-                     EqualTo>
-      objects_;
+  std::array<internal::Slot, kCapacity> slots_;
 };
 
 }  // namespace composite
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "type_index.h"
+
+namespace composite {
+
+// Identifies an entity of a Registry. Ids of destroyed entities are reused
+// with a new generation, so stale copies are detected.
+struct Entity {
+  static constexpr std::uint32_t kInvalidIndex = ~std::uint32_t{0};
+
+  bool IsValid() const { return index != kInvalidIndex; }
+
+  bool operator==(const Entity& o) const {
+    return index == o.index && generation == o.generation;
+  }
+  bool operator!=(const Entity& o) const { return !(*this == o); }
+
+  std::uint32_t index = kInvalidIndex;
+  std::uint32_t generation = 0;
+};
+
+namespace internal {
+
+// Maps entity indices to positions in a packed array. Removal swaps the last
+// element into the hole, so the packed array never has gaps.
+class SparseSet {
+ public:
+  virtual ~SparseSet() = default;
+
+  bool Contains(std::uint32_t index) const {
+    return index < sparse_.size() && sparse_[index] != kAbsent;
+  }
+
+  std::size_t Size() const { return packed_.size(); }
+
+  // Entity indices, in the order of the packed components.
+  const std::vector<std::uint32_t>& GetIndices() const { return packed_; }
+
+  virtual void Remove(std::uint32_t index) = 0;
+
+ protected:
+  static constexpr std::uint32_t kAbsent = ~std::uint32_t{0};
+
+  std::size_t GetSlot(std::uint32_t index) const { return sparse_[index]; }
+
+  std::size_t Insert(std::uint32_t index) {
+    if (sparse_.size() <= index)
+      sparse_.resize(index + 1, kAbsent);
+    sparse_[index] = static_cast<std::uint32_t>(packed_.size());
+    packed_.push_back(index);
+    return packed_.size() - 1;
+  }
+
+  // Returns the slot that was freed, after moving the last entity into it.
+  std::size_t Erase(std::uint32_t index) {
+    const std::uint32_t slot = sparse_[index];
+    const std::uint32_t last = packed_.back();
+    packed_[slot] = last;
+    sparse_[last] = slot;
+    packed_.pop_back();
+    sparse_[index] = kAbsent;
+    return slot;
+  }
+
+ private:
+  std::vector<std::uint32_t> sparse_;
+  std::vector<std::uint32_t> packed_;
+};
+
+template <typename Component>
+class ComponentSet final : public SparseSet {
+ public:
+  template <typename... Args>
+  Component& Emplace(std::uint32_t index, Args&&... args) {
+    if (Contains(index)) {
+      Component& component = components_[GetSlot(index)];
+      component = Component(std::forward<Args>(args)...);
+      return component;
+    }
+    Insert(index);
+    return components_.emplace_back(std::forward<Args>(args)...);
+  }
+
+  void Remove(std::uint32_t index) final {
+    if (!Contains(index))
+      return;
+    const std::size_t slot = Erase(index);
+    if (slot != components_.size() - 1)
+      components_[slot] = std::move(components_.back());
+    components_.pop_back();
+  }
+
+  Component& Get(std::uint32_t index) { return components_[GetSlot(index)]; }
+  const Component& Get(std::uint32_t index) const {
+    return components_[GetSlot(index)];
+  }
+
+  // Packed components, matching GetIndices().
+  std::vector<Component>& GetComponents() { return components_; }
+
+ private:
+  std::vector<Component> components_;
+};
+
+}  // namespace internal
+
+// Entity-component registry. Components of one type are stored contiguously,
+// one packed array per type, indexed by GetTypeIndex() instead of a hash of
+// the type. Pointers and references to components are invalidated when
+// components of the same type are added or removed.
+class Registry {
+ public:
+  Entity Create() {
+    std::uint32_t index;
+    if (!free_.empty()) {
+      index = free_.back();
+      free_.pop_back();
+    } else {
+      index = static_cast<std::uint32_t>(generations_.size());
+      generations_.push_back(0);
+    }
+    ++alive_;
+    return {index, generations_[index]};
+  }
+
+  // Removes all components of |entity|. Stale entities are ignored.
+  void Destroy(Entity entity) {
+    if (!IsAlive(entity))
+      return;
+    for (auto& set : sets_) {
+      if (set)
+        set->Remove(entity.index);
+    }
+    ++generations_[entity.index];
+    free_.push_back(entity.index);
+    --alive_;
+  }
+
+  bool IsAlive(Entity entity) const {
+    return entity.index < generations_.size() &&
+           generations_[entity.index] == entity.generation;
+  }
+
+  std::size_t Size() const { return alive_; }
+
+  // Adds a component to |entity| or replaces the one it has.
+  template <typename Component, typename... Args>
+  Component& Emplace(Entity entity, Args&&... args) {
+    CheckAlive(entity);
+    return GetOrCreateSet<Component>().Emplace(entity.index,
+                                               std::forward<Args>(args)...);
+  }
+
+  template <typename Component>
+  void Remove(Entity entity) {
+    CheckAlive(entity);
+    if (auto* set = FindSet<Component>())
+      set->Remove(entity.index);
+  }
+
+  template <typename Component>
+  bool Has(Entity entity) const {
+    const auto* set = FindSet<Component>();
+    return IsAlive(entity) && set && set->Contains(entity.index);
+  }
+
+  // Returns nullptr if |entity| has no such component or is stale.
+  template <typename Component>
+  Component* Get(Entity entity) {
+    auto* set = FindSet<Component>();
+    if (!IsAlive(entity) || !set || !set->Contains(entity.index))
+      return nullptr;
+    return &set->Get(entity.index);
+  }
+
+  template <typename Component>
+  const Component* Get(Entity entity) const {
+    const auto* set = FindSet<Component>();
+    if (!IsAlive(entity) || !set || !set->Contains(entity.index))
+      return nullptr;
+    return &set->Get(entity.index);
+  }
+
+  template <typename Component>
+  std::size_t Count() const {
+    const auto* set = FindSet<Component>();
+    return set ? set->Size() : 0;
+  }
+
+  // Calls f(Entity, First&, Rest&...) for every entity having all the listed
+  // components. Iteration walks the packed array of First; put the rarest
+  // component first. |f| must not add or remove components of these types.
+  template <typename First, typename... Rest, typename F>
+  void Each(F&& f) {
+    auto* first = FindSet<First>();
+    const std::tuple<Set<Rest>*...> rest{FindSet<Rest>()...};
+    if (!first || (!std::get<Set<Rest>*>(rest) || ...))
+      return;
+
+    const auto& indices = first->GetIndices();
+    auto& components = first->GetComponents();
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+      const std::uint32_t index = indices[i];
+      if (!(std::get<Set<Rest>*>(rest)->Contains(index) && ...))
+        continue;
+      f(Entity{index, generations_[index]}, components[i],
+        std::get<Set<Rest>*>(rest)->Get(index)...);
+    }
+  }
+
+ private:
+  template <typename Component>
+  using Set = internal::ComponentSet<Component>;
+
+  void CheckAlive(Entity entity) const {
+    if (!IsAlive(entity))
+      throw std::invalid_argument("Stale entity " +
+                                  std::to_string(entity.index));
+  }
+
+  template <typename Component>
+  Set<Component>* FindSet() const {
+    const TypeIndex type = GetTypeIndex<Component>();
+    if (type >= sets_.size())
+      return nullptr;
+    return static_cast<Set<Component>*>(sets_[type].get());
+  }
+
+  template <typename Component>
+  Set<Component>& GetOrCreateSet() {
+    const TypeIndex type = GetTypeIndex<Component>();
+    if (sets_.size() <= type)
+      sets_.resize(type + 1);
+    if (!sets_[type])
+      sets_[type] = std::make_unique<Set<Component>>();
+    return static_cast<Set<Component>&>(*sets_[type]);
+  }
+
+  std::vector<std::unique_ptr<internal::SparseSet>> sets_;
+  std::vector<std::uint32_t> generations_;
+  std::vector<std::uint32_t> free_;
+  std::size_t alive_ = 0;
+};
+
+}  // namespace composite
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace composite {
+
+using TypeIndex = std::size_t;
+
+// Returned by FindTypeIndex() for a type that has no index yet.
+constexpr TypeIndex kNoTypeIndex = static_cast<TypeIndex>(-1);
+
+namespace internal {
+
+template <typename Family>
+TypeIndex NextTypeIndex() {
+  static std::atomic<TypeIndex> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Index of |T| in |Family| once GetTypeIndex() assigned one.
+template <typename T, typename Family>
+std::atomic<TypeIndex>& AssignedTypeIndex() {
+  static std::atomic<TypeIndex> index{kNoTypeIndex};
+  return index;
+}
+
+}  // namespace internal
+
+// Small dense integer identifying |T|, usable as an array index instead of
+// hashing std::type_info. Indices are handed out in order of first use and
+// stay the same for the whole run; cv-qualifiers and references are ignored.
+// Each |Family| numbers its types separately from 0, so a container that only
+// ever sees a few types can keep them in a small fixed array.
+template <typename T, typename Family = void>
+TypeIndex GetTypeIndex() {
+  using Type = std::remove_cv_t<std::remove_reference_t<T>>;
+  if constexpr (!std::is_same_v<Type, T>) {
+    return GetTypeIndex<Type, Family>();
+  } else {
+    static const TypeIndex index = [] {
+      const TypeIndex next = internal::NextTypeIndex<Family>();
+      internal::AssignedTypeIndex<Type, Family>().store(
+          next, std::memory_order_release);
+      return next;
+    }();
+    return index;
+  }
+}
+
+// Same as GetTypeIndex(), but returns kNoTypeIndex instead of assigning an
+// index to a type that doesn't have one yet. Lookups use it, so that asking
+// for a type that was never stored doesn't use up an index of the family.
+template <typename T, typename Family = void>
+TypeIndex FindTypeIndex() {
+  using Type = std::remove_cv_t<std::remove_reference_t<T>>;
+  return internal::AssignedTypeIndex<Type, Family>().load(
+      std::memory_order_acquire);
+}
+
+}  // namespace composite
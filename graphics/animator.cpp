@@ -0,0 +1,147 @@
+#include "animator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "graphics.h"
+
+namespace render {
+
+namespace {
+
+// Backwards playback starts on the last frame of the sequence.
+float GetStartTime(AnimationHandle animation, float frames_per_second) {
+  if (frames_per_second >= 0.f)
+    return 0.f;
+  return std::max(static_cast<float>(animation.frame_count) - 1.f, 0.f);
+}
+
+}  // namespace
+
+Animator::Id Animator::Add(AnimationHandle animation,
+                           float frames_per_second,
+                           bool looping) {
+  Id id;
+  if (!free_ids_.empty()) {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  } else {
+    id = static_cast<Id>(slots_.size());
+    slots_.push_back(kInvalidId);
+  }
+
+  slots_[id] = static_cast<std::uint32_t>(ids_.size());
+  animations_.push_back(animation);
+  time_.push_back(GetStartTime(animation, frames_per_second));
+  speed_.push_back(frames_per_second);
+  looping_.push_back(looping);
+  ids_.push_back(id);
+  return id;
+}
+
+void Animator::Remove(Id id) {
+  const std::size_t slot = GetSlot(id);
+  const std::size_t last = ids_.size() - 1;
+  if (slot != last) {
+    animations_[slot] = animations_[last];
+    time_[slot] = time_[last];
+    speed_[slot] = speed_[last];
+    looping_[slot] = looping_[last];
+    ids_[slot] = ids_[last];
+    slots_[ids_[slot]] = static_cast<std::uint32_t>(slot);
+  }
+  animations_.pop_back();
+  time_.pop_back();
+  speed_.pop_back();
+  looping_.pop_back();
+  ids_.pop_back();
+
+  slots_[id] = kInvalidId;
+  free_ids_.push_back(id);
+}
+
+void Animator::Clear() {
+  animations_.clear();
+  time_.clear();
+  speed_.clear();
+  looping_.clear();
+  ids_.clear();
+  slots_.clear();
+  free_ids_.clear();
+}
+
+void Animator::Reserve(std::size_t count) {
+  animations_.reserve(count);
+  time_.reserve(count);
+  speed_.reserve(count);
+  looping_.reserve(count);
+  ids_.reserve(count);
+  slots_.reserve(count);
+}
+
+void Animator::Play(Id id, AnimationHandle animation) {
+  const std::size_t slot = GetSlot(id);
+  animations_[slot] = animation;
+  time_[slot] = GetStartTime(animation, speed_[slot]);
+}
+
+void Animator::SetSpeed(Id id, float frames_per_second) {
+  const std::size_t slot = GetSlot(id);
+  // A finished animation turned backwards replays from its last frame.
+  if (frames_per_second < 0.f && IsFinished(id))
+    time_[slot] = GetStartTime(animations_[slot], frames_per_second);
+  speed_[slot] = frames_per_second;
+}
+
+void Animator::Update(float dt) {
+  const std::size_t count = ids_.size();
+  for (std::size_t i = 0; i < count; ++i) {
+    const float length = static_cast<float>(animations_[i].frame_count);
+    float time = time_[i] + speed_[i] * dt;
+    if (looping_[i] && length > 0.f) {
+      time = std::fmod(time, length);
+      if (time < 0.f)
+        time += length;
+    } else {
+      time = std::clamp(time, 0.f, std::max(length - 1.f, 0.f));
+    }
+    time_[i] = time;
+  }
+}
+
+AnimationHandle Animator::GetAnimation(Id id) const {
+  return animations_[GetSlot(id)];
+}
+
+int Animator::GetFrame(Id id) const {
+  return static_cast<int>(time_[GetSlot(id)]);
+}
+
+bool Animator::IsFinished(Id id) const {
+  const std::size_t slot = GetSlot(id);
+  if (looping_[slot])
+    return false;
+  const int last = static_cast<int>(animations_[slot].frame_count) - 1;
+  return speed_[slot] < 0.f ? time_[slot] <= 0.f
+                            : static_cast<int>(time_[slot]) >= last;
+}
+
+void Animator::Draw(Id id, int x, int y, int w, int h) const {
+  const std::size_t slot = GetSlot(id);
+  DrawAnimationFrame(animations_[slot], static_cast<int>(time_[slot]), x, y, w,
+                     h);
+}
+
+std::size_t Animator::Size() const {
+  return ids_.size();
+}
+
+std::size_t Animator::GetSlot(Id id) const {
+  if (id >= slots_.size() || slots_[id] == kInvalidId)
+    throw std::invalid_argument("Unknown animation id " + std::to_string(id));
+  return slots_[id];
+}
+
+}  // namespace render
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "texture_handle.h"
+
+namespace render {
+
+// Playback state of many animations, kept in packed arrays and advanced
+// all at once by Update(), so game code only keeps an Id per entity.
+//
+// Ping-pong lines need no special handling here: their reverse run is
+// already part of the baked sequence (see Atlas::Bake()).
+class Animator {
+ public:
+  using Id = std::uint32_t;
+
+  static constexpr Id kInvalidId = UINT32_MAX;
+
+  // |frames_per_second| may be negative to play backwards, starting from the
+  // last frame. A non looping animation stops on the last frame it reaches.
+  Id Add(AnimationHandle animation,
+         float frames_per_second,
+         bool looping = true);
+  // |id| may be reused by a later Add().
+  void Remove(Id id);
+  void Clear();
+  void Reserve(std::size_t count);
+
+  // Switches |id| to another line and restarts it from the first frame, or
+  // the last one when playing backwards.
+  void Play(Id id, AnimationHandle animation);
+  // Turning a finished animation backwards restarts it from the last frame.
+  void SetSpeed(Id id, float frames_per_second);
+
+  void Update(float dt);
+
+  AnimationHandle GetAnimation(Id id) const;
+  // Index into the animation's sequence, for DrawAnimationFrame().
+  int GetFrame(Id id) const;
+  bool IsFinished(Id id) const;
+  void Draw(Id id, int x, int y, int w = 0, int h = 0) const;
+
+  std::size_t Size() const;
+
+ private:
+  std::size_t GetSlot(Id id) const;
+
+  // Packed, in the same order.
+  std::vector<AnimationHandle> animations_;
+  std::vector<float> time_;  // In frames since the start of the sequence.
+  std::vector<float> speed_;
+  std::vector<std::uint8_t> looping_;
+  std::vector<Id> ids_;
+
+  // Slot of each id, kInvalidId for removed ones.
+  std::vector<std::uint32_t> slots_;
+  std::vector<Id> free_ids_;
+};
+
+}  // namespace render
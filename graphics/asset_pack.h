@@ -0,0 +1,63 @@
+#pragma once
+
+#include "texture_handle.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+namespace render {
+
+// Binary asset pack: pre-decoded RGBA32 pages plus the rectangles of the
+// images packed into them, written by tools/asset_packer and uploaded
+// straight from a memory mapping at runtime.
+//
+// Layout, little-endian:
+//   asset_pack::Header
+//   Page[page_count]
+//   Entry[entry_count]
+//   entry names, not null terminated
+//   page pixels, each at a kAlignment aligned offset, rows of
+//   width * 4 bytes
+namespace asset_pack {
+
+constexpr char kMagic[4] = {'G', 'B', 'P', 'K'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint64_t kAlignment = 16;
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t page_count;
+  std::uint32_t entry_count;
+};
+
+struct Page {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint64_t pixels_offset;
+};
+
+struct Entry {
+  std::uint32_t page;
+  std::int32_t x;
+  std::int32_t y;
+  std::int32_t w;
+  std::int32_t h;
+  std::uint32_t name_offset;
+  std::uint32_t name_length;
+};
+
+static_assert(sizeof(Header) == 16, "Asset pack header must be packed");
+static_assert(sizeof(Page) == 16, "Asset pack page must be packed");
+static_assert(sizeof(Entry) == 28, "Asset pack entry must be packed");
+
+}  // namespace asset_pack
+
+// Maps |path| and uploads its pages as textures, registering every entry
+// under its name like LoadPackedResources(). Returns the entry handles in
+// pack order.
+std::vector<TextureHandle> LoadAssetPack(const std::filesystem::path& path);
+
+}  // namespace render
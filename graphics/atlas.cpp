@@ -29,7 +29,8 @@ Atlas Atlas::Create(const std::filesystem::path& path,
   return Atlas(LoadResource(path, name));
 }
 
-Atlas::Atlas(const std::string& name) : name_(name) {}
+Atlas::Atlas(TextureHandle texture)
+    : name_(GetTextureName(texture)), texture_(texture) {}
 
 Atlas::AnimationLine& Atlas::AddAnimationLine(const std::string& name) {
   try {
@@ -48,6 +49,10 @@ const std::string& Atlas::GetName() const {
   return name_;
 }
 
+TextureHandle Atlas::GetTextureHandle() const {
+  return texture_;
+}
+
 const Atlas::AnimationLine& Atlas::GetAnimationLine(const std::string& name) const {
   auto fnd = std::find_if(animation_lines_.begin(), animation_lines_.end(),
                           [&name](const auto& al) { return al.name == name; });
@@ -59,15 +64,14 @@ const Atlas::AnimationLine& Atlas::GetAnimationLine(const std::string& name) con
 }
 
 void Atlas::Bake() {
-  auto* texture = GetTexture(name_);
+  const SDL_Rect rect = GetTextureRect(texture_);
 
   if (animation_lines_.empty()) {
     throw std::logic_error(name_ + " atlas has no animation lines");
   }
 
-  int width = 0;
-  int height = 0;
-  SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+  int width = rect.w;
+  int height = rect.h;
 
   height = height / animation_lines_.size();
   int y_offset = 0;
@@ -92,6 +96,28 @@ void Atlas::Bake() {
     }
     y_offset += al.frame_height;
   }
+
+  frames_.clear();
+  for (auto& al : animation_lines_) {
+    al.first_frame = static_cast<int>(frames_.size());
+    auto add_frame = [&](int frame) {
+      frames_.push_back({rect.x + frame * al.frame_width, rect.y + al.y_offset,
+                         al.frame_width, al.frame_height});
+    };
+    for (int frame = 0; frame < al.frames_count; ++frame) {
+      add_frame(frame);
+    }
+    if (al.with_reverse) {
+      for (int frame = al.frames_count - 2; frame > 0; --frame) {
+        add_frame(frame);
+      }
+    }
+    al.sequence_length = static_cast<int>(frames_.size()) - al.first_frame;
+  }
+}
+
+const std::vector<SDL_Rect>& Atlas::GetFrames() const {
+  return frames_;
 }
 
 }  // namespace render
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <SDL.h>
+
 #include <cstddef>
 #include <filesystem>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "texture_handle.h"
+
 
 namespace render {
 
@@ -20,6 +24,10 @@ class Atlas {
     int frame_height = 0;
     bool with_reverse = false;
 
+    // Filled by Bake(): the line's frames in GetFrames(), in play order.
+    int first_frame = 0;
+    int sequence_length = 0;
+
     AnimationLine& SetFramesCount(int count, bool with_reverse = false);
     AnimationLine& SetFrameWidth(int width);
     AnimationLine& SetFrameHeight(int height);
@@ -31,16 +39,23 @@ class Atlas {
   AnimationLine& AddAnimationLine(const std::string& name);
 
   const std::string& GetName() const;
+  TextureHandle GetTextureHandle() const;
   const AnimationLine& GetAnimationLine(const std::string& name) const;
+  // Computes the missing line fields and the source rectangle of every
+  // frame of every line, reverse runs included.
   void Bake();
+  // Source rectangles inside GetTexture(GetTextureHandle()).
+  const std::vector<SDL_Rect>& GetFrames() const;
 
   Atlas() = default;
 
  private:
-  explicit Atlas(const std::string& name);
+  explicit Atlas(TextureHandle texture);
 
   std::string name_;
+  TextureHandle texture_;
   std::vector<AnimationLine> animation_lines_;
+  std::vector<SDL_Rect> frames_;
 };
 
 }  // namespace render
@@ -1,14 +1,26 @@
 #include "graphics.h"
+#include "asset_pack.h"
 #include "atlas.h"
+#include "mapped_file.h"
+#include "rect_packer.h"
 
 #include <SDL.h>
 #include <SDL_image.h>
 
+#include <algorithm>
 #include <exception>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <list>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 
 namespace render {
@@ -22,112 +34,615 @@ SDL_Renderer* GetRenderer() {
 SDL_Window* RenderWindow::sdl_window_ = nullptr;
 SDL_Renderer* RenderWindow::sdl_renderer_ = nullptr;
 
-RenderWindow::RenderWindow(int width, int height)
-    : width_(width), height_(height) {
+RenderWindow::RenderWindow(int width, int height, Mode mode)
+    : width_(width), height_(height), mode_(mode) {
   if (sdl_window_ || sdl_renderer_)
     throw std::logic_error("Renderer window already exist");
 
-  SDL_Init(SDL_INIT_EVERYTHING);
+  const char* headless = std::getenv("GAMEBASE_HEADLESS");
+  if (headless && *headless && std::strcmp(headless, "0") != 0)
+    mode_ = Mode::kHeadless;
+
+  if (IsHeadless()) {
+    // Audio, joystick or haptic subsystems may be missing on CI machines,
+    // and a headless run needs none of them.
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+      throw std::runtime_error(std::string("Failed to initialize SDL: ") +
+                               SDL_GetError());
+    }
+  } else {
+    SDL_Init(SDL_INIT_EVERYTHING);
+  }
 
-  sdl_window_ =
-      SDL_CreateWindow("GAME", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                       width_, height_, SDL_WINDOW_RESIZABLE);
+  if (!IsHeadless()) {
+    sdl_window_ = SDL_CreateWindow("GAME", SDL_WINDOWPOS_CENTERED,
+                                   SDL_WINDOWPOS_CENTERED, width_, height_,
+                                   SDL_WINDOW_RESIZABLE);
+
+    sdl_renderer_ =
+        SDL_CreateRenderer(sdl_window_, -1, SDL_RENDERER_ACCELERATED);
+    return;
+  }
 
-  sdl_renderer_ = SDL_CreateRenderer(sdl_window_, -1, SDL_RENDERER_ACCELERATED);
+  sdl_window_ = SDL_CreateWindow("GAME", SDL_WINDOWPOS_UNDEFINED,
+                                 SDL_WINDOWPOS_UNDEFINED, width_, height_,
+                                 SDL_WINDOW_HIDDEN);
+  sdl_renderer_ = SDL_CreateRenderer(
+      sdl_window_, -1, SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE);
+  if (sdl_renderer_) {
+    offscreen_target_ =
+        SDL_CreateTexture(sdl_renderer_, SDL_PIXELFORMAT_RGBA32,
+                          SDL_TEXTUREACCESS_TARGET, width_, height_);
+  }
+  if (!offscreen_target_ ||
+      SDL_SetRenderTarget(sdl_renderer_, offscreen_target_) != 0) {
+    const std::string error = SDL_GetError();
+    SDL_DestroyRenderer(sdl_renderer_);
+    SDL_DestroyWindow(sdl_window_);
+    sdl_renderer_ = nullptr;
+    sdl_window_ = nullptr;
+    SDL_Quit();
+    throw std::runtime_error("Can't create headless renderer: " + error);
+  }
 }
 
 RenderWindow::~RenderWindow() {
+  if (offscreen_target_)
+    SDL_DestroyTexture(offscreen_target_);
   SDL_DestroyRenderer(sdl_renderer_);
   SDL_DestroyWindow(sdl_window_);
+  sdl_renderer_ = nullptr;
+  sdl_window_ = nullptr;
   SDL_Quit();
 }
 
+bool RenderWindow::IsHeadless() const {
+  return mode_ == Mode::kHeadless;
+}
+
 }  // namespace render
 
 namespace render {
 
+namespace {
+
+// Decodes an image file to an RGBA32 surface, nullptr on failure. Touches no
+// renderer state, so it may run on any thread.
+SDL_Surface* DecodeImage(const std::filesystem::path& path) {
+  SDL_Surface* loaded = IMG_Load(path.string().c_str());
+  if (!loaded)
+    return nullptr;
+  SDL_Surface* surface =
+      SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(loaded);
+  return surface;
+}
+
+}  // namespace
+
 class ResourceManager {
  public:
+  // The texture is resolved when the frame is drawn, so a frame follows its
+  // atlas when the texture is registered again.
+  struct Frame {
+    TextureHandle texture;
+    SDL_Rect source = {};
+  };
+
+  struct Texture {
+    std::string name;
+    SDL_Texture* texture = nullptr;
+    // Part of |texture| holding the image, all of it unless packed.
+    SDL_Rect source = {};
+    // False for images packed into a shared page.
+    bool owns_texture = true;
+  };
+
   static ResourceManager& GetInstance() {
     static ResourceManager instance;
     return instance;
   }
 
-  void LoadResource(const std::filesystem::path& path,
-                    const std::string& name) {
+  TextureHandle LoadResource(const std::filesystem::path& path,
+                             const std::string& name) {
     SDL_Texture* texture =
         IMG_LoadTexture(GetRenderer(), path.string().c_str());
     if (!texture)
       throw std::invalid_argument("Can't find resource: " + path.string());
-    textures_[name] = texture;
+
+    SDL_Rect source = {};
+    SDL_QueryTexture(texture, nullptr, nullptr, &source.w, &source.h);
+    return Register(name, texture, source, true);
   }
 
+  // Adds or replaces the |name| entry. Replacing keeps the handle.
+  TextureHandle Register(const std::string& name,
+                         SDL_Texture* texture,
+                         const SDL_Rect& source,
+                         bool owns_texture) {
+    TextureHandle handle = FindHandle(name);
+    if (!handle.IsValid()) {
+      handle.index = static_cast<std::uint32_t>(textures_.size());
+      textures_.emplace_back();
+      textures_.back().name = name;
+      handles_[name] = handle;
+    }
+
+    Texture& entry = textures_[handle.index];
+    if (entry.texture && entry.owns_texture)
+      SDL_DestroyTexture(entry.texture);
+    entry.texture = texture;
+    entry.source = source;
+    entry.owns_texture = owns_texture;
+    return handle;
+  }
+
+  TextureHandle LoadResourceAsync(const std::filesystem::path& path,
+                                  const std::string& name) {
+    const TextureHandle handle = Register(name, nullptr, {}, true);
+    pending_.push_back(
+        {handle, path, std::async(std::launch::async, DecodeImage, path)});
+    ++async_total_;
+    return handle;
+  }
+
+  bool UpdateAsyncLoads(Uint32 budget_ms) {
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 deadline =
+        SDL_GetPerformanceCounter() + frequency * budget_ms / 1000;
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      if (it->surface.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+        ++it;
+        continue;
+      }
+
+      SDL_Surface* surface = it->surface.get();
+      const PendingLoad load = {it->handle, it->path, {}};
+      it = pending_.erase(it);
+      ++async_done_;
+      Upload(load, surface);
+
+      if (SDL_GetPerformanceCounter() >= deadline)
+        break;
+    }
+    return pending_.empty();
+  }
+
+  void WaitForAsyncLoads() {
+    while (!pending_.empty()) {
+      pending_.front().surface.wait();
+      UpdateAsyncLoads(~Uint32{0} / 1000);
+    }
+  }
+
+  LoadingProgress GetLoadingProgress() const {
+    return {async_done_, async_total_};
+  }
+
+  // Takes ownership of a texture shared by packed entries.
+  void AddPage(SDL_Texture* page) { pages_.push_back(page); }
+
   void FreeAllResources() {
-    for (auto& [name, texture] : textures_) {
-      SDL_DestroyTexture(texture);
+    for (auto& load : pending_) {
+      SDL_FreeSurface(load.surface.get());
+    }
+    pending_.clear();
+    async_done_ = 0;
+    async_total_ = 0;
+
+    for (auto& entry : textures_) {
+      if (entry.owns_texture)
+        SDL_DestroyTexture(entry.texture);
     }
+    for (auto* page : pages_) {
+      SDL_DestroyTexture(page);
+    }
+    pages_.clear();
     textures_.clear();
+    frames_.clear();
+    atlas_first_frames_.clear();
+    handles_.clear();
+    atlases_.clear();
   }
 
-  void AddAtlas(Atlas&& atlas) { atlases_[atlas.GetName()] = std::move(atlas); }
+  void AddAtlas(Atlas&& atlas) {
+    const TextureHandle handle = atlas.GetTextureHandle();
+    if (atlases_.size() <= handle.index) {
+      atlases_.resize(handle.index + 1);
+      atlas_first_frames_.resize(handle.index + 1);
+    }
 
-  SDL_Texture* GetTexture(const std::string& name) {
-    auto fnd = textures_.find(name);
-    if (fnd == textures_.end())
-      return nullptr;
+    atlas_first_frames_[handle.index] =
+        static_cast<std::uint32_t>(frames_.size());
+    for (const SDL_Rect& source : atlas.GetFrames()) {
+      frames_.push_back({handle, source});
+    }
+    atlases_[handle.index] = std::move(atlas);
+  }
+
+  AnimationHandle GetAnimation(TextureHandle handle,
+                               const std::string& line) const {
+    const auto& al = GetAtlas(handle).GetAnimationLine(line);
+    return {atlas_first_frames_[handle.index] + al.first_frame,
+            static_cast<std::uint32_t>(al.sequence_length)};
+  }
+
+  const Frame& GetFrame(std::uint32_t index) const { return frames_[index]; }
+
+  TextureHandle FindHandle(const std::string& name) const {
+    auto fnd = handles_.find(name);
+    if (fnd == handles_.end())
+      return {};
     return fnd->second;
   }
 
+  const Texture* GetTexture(TextureHandle handle) const {
+    if (handle.index >= textures_.size())
+      return nullptr;
+    return &textures_[handle.index];
+  }
+
+  const Atlas& GetAtlas(TextureHandle handle) const {
+    if (handle.index >= atlases_.size() || !atlases_[handle.index])
+      throw std::invalid_argument("Atlas for texture " +
+                                  std::to_string(handle.index) +
+                                  " doesn't exist");
+    return *atlases_[handle.index];
+  }
+
   const Atlas& GetAtlas(const std::string& name) const {
-    auto fnd = atlases_.find(name);
-    if (fnd == atlases_.end())
+    const TextureHandle handle = FindHandle(name);
+    if (handle.index >= atlases_.size() || !atlases_[handle.index])
       throw std::invalid_argument(name + " doesn't exist");
-    return fnd->second;
+    return *atlases_[handle.index];
   }
 
  private:
+  struct PendingLoad {
+    TextureHandle handle;
+    std::filesystem::path path;
+    std::future<SDL_Surface*> surface;
+  };
+
+  // Initializes SDL_image here, on the main thread, because IMG_Load() would
+  // otherwise set up its loaders lazily from several decoding threads.
   ResourceManager() {
     if (!RenderWindow::sdl_window_)
       throw std::logic_error("Initialize RenderWindow first");
+    constexpr int kFormats = IMG_INIT_PNG | IMG_INIT_JPG;
+    if ((IMG_Init(kFormats) & kFormats) != kFormats)
+      throw std::runtime_error(std::string("Can't initialize SDL_image: ") +
+                               IMG_GetError());
   }
 
-  ~ResourceManager() { FreeAllResources(); }
+  ~ResourceManager() {
+    FreeAllResources();
+    IMG_Quit();
+  }
 
-  std::unordered_map<std::string, SDL_Texture*> textures_;
-  std::unordered_map<std::string, Atlas> atlases_;
+  void Upload(const PendingLoad& load, SDL_Surface* surface) {
+    if (!surface)
+      throw std::invalid_argument("Can't find resource: " +
+                                  load.path.string());
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(GetRenderer(), surface);
+    const SDL_Rect source = {0, 0, surface->w, surface->h};
+    SDL_FreeSurface(surface);
+    if (!texture)
+      throw std::runtime_error(std::string("Can't create texture: ") +
+                               SDL_GetError());
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    Register(GetTexture(load.handle)->name, texture, source, true);
+  }
+
+  std::vector<Texture> textures_;
+  std::vector<SDL_Texture*> pages_;
+  std::list<PendingLoad> pending_;
+  std::size_t async_done_ = 0;
+  std::size_t async_total_ = 0;
+  std::unordered_map<std::string, TextureHandle> handles_;
+  // Indexed by the texture handle of the atlas image.
+  std::vector<std::optional<Atlas>> atlases_;
+  std::vector<std::uint32_t> atlas_first_frames_;
+  // Frames of every baked atlas, see AnimationHandle.
+  std::vector<Frame> frames_;
 };
 
-std::string LoadResource(const std::filesystem::path& path,
-                         const std::string& name) {
+namespace {
+
+const ResourceManager::Texture& GetTextureEntry(TextureHandle handle) {
+  const auto* entry = ResourceManager::GetInstance().GetTexture(handle);
+  if (!entry)
+    throw std::invalid_argument("Texture handle " +
+                                std::to_string(handle.index) +
+                                " is not loaded.");
+  return *entry;
+}
+
+}  // namespace
+
+TextureHandle LoadResource(const std::filesystem::path& path,
+                           const std::string& name) {
   if (!name.empty()) {
-    ResourceManager::GetInstance().LoadResource(path, name);
-    return name;
+    return ResourceManager::GetInstance().LoadResource(path, name);
   } else {
-    ResourceManager::GetInstance().LoadResource(path, path.filename().string());
-    return path.filename().string();
+    return ResourceManager::GetInstance().LoadResource(
+        path, path.filename().string());
   }
 }
 
+std::string ResourceName(const PackedResource& resource) {
+  return resource.name.empty() ? resource.path.filename().string()
+                               : resource.name;
+}
+
+std::vector<TextureHandle> LoadAssetPack(const std::filesystem::path& path) {
+  const MappedFile file(path);
+  const std::uint8_t* data = file.GetData();
+  const std::size_t size = file.GetSize();
+  auto check = [&path, size](std::uint64_t offset, std::uint64_t length) {
+    if (offset > size || length > size - offset)
+      throw std::runtime_error("Corrupted asset pack: " + path.string());
+  };
+
+  asset_pack::Header header;
+  check(0, sizeof(header));
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, asset_pack::kMagic, sizeof(header.magic)) ||
+      header.version != asset_pack::kVersion) {
+    throw std::runtime_error("Not an asset pack: " + path.string());
+  }
+
+  const std::uint64_t pages_offset = sizeof(header);
+  const std::uint64_t entries_offset =
+      pages_offset +
+      std::uint64_t{header.page_count} * sizeof(asset_pack::Page);
+  const std::uint64_t names_offset =
+      entries_offset +
+      std::uint64_t{header.entry_count} * sizeof(asset_pack::Entry);
+  check(pages_offset, names_offset - pages_offset);
+
+  auto& manager = ResourceManager::GetInstance();
+  std::vector<SDL_Texture*> pages;
+  std::vector<asset_pack::Page> page_sizes;
+  for (std::uint32_t i = 0; i < header.page_count; ++i) {
+    asset_pack::Page page;
+    std::memcpy(&page, data + pages_offset + i * sizeof(page), sizeof(page));
+    page_sizes.push_back(page);
+    check(page.pixels_offset, std::uint64_t{page.width} * page.height * 4);
+
+    SDL_Texture* texture =
+        SDL_CreateTexture(GetRenderer(), SDL_PIXELFORMAT_RGBA32,
+                          SDL_TEXTUREACCESS_STATIC, page.width, page.height);
+    if (!texture)
+      throw std::runtime_error(std::string("Can't create texture: ") +
+                               SDL_GetError());
+    manager.AddPage(texture);
+    SDL_UpdateTexture(texture, nullptr, data + page.pixels_offset,
+                      static_cast<int>(page.width * 4));
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    pages.push_back(texture);
+  }
+
+  std::vector<TextureHandle> handles;
+  for (std::uint32_t i = 0; i < header.entry_count; ++i) {
+    asset_pack::Entry entry;
+    std::memcpy(&entry, data + entries_offset + i * sizeof(entry),
+                sizeof(entry));
+    check(names_offset + entry.name_offset, entry.name_length);
+    if (entry.page >= pages.size() || entry.x < 0 || entry.y < 0 ||
+        entry.w < 0 || entry.h < 0 ||
+        std::int64_t{entry.x} + entry.w > page_sizes[entry.page].width ||
+        std::int64_t{entry.y} + entry.h > page_sizes[entry.page].height) {
+      throw std::runtime_error("Corrupted asset pack: " + path.string());
+    }
+
+    const std::string name(
+        reinterpret_cast<const char*>(data + names_offset + entry.name_offset),
+        entry.name_length);
+    handles.push_back(manager.Register(name, pages[entry.page],
+                                       {entry.x, entry.y, entry.w, entry.h},
+                                       false));
+  }
+  return handles;
+}
+
 void BakeAtlas(Atlas& atlas) {
   atlas.Bake();
   ResourceManager::GetInstance().AddAtlas(std::move(atlas));
 }
 
-SDL_Texture* GetTexture(const std::string& name) {
-  auto* texture = ResourceManager::GetInstance().GetTexture(name);
-  if (!texture)
+TextureHandle GetTextureHandle(const std::string& name) {
+  auto handle = ResourceManager::GetInstance().FindHandle(name);
+  if (!handle.IsValid())
     throw std::invalid_argument("Texture " + name + " is not loaded.");
-  return texture;
+  return handle;
+}
+
+const std::string& GetTextureName(TextureHandle handle) {
+  return GetTextureEntry(handle).name;
+}
+
+SDL_Texture* GetTexture(const std::string& name) {
+  return GetTexture(GetTextureHandle(name));
+}
+
+SDL_Texture* GetTexture(TextureHandle handle) {
+  return GetTextureEntry(handle).texture;
+}
+
+SDL_Rect GetTextureRect(TextureHandle handle) {
+  return GetTextureEntry(handle).source;
+}
+
+TextureHandle LoadResourceAsync(const std::filesystem::path& path,
+                                const std::string& name) {
+  return ResourceManager::GetInstance().LoadResourceAsync(
+      path, name.empty() ? path.filename().string() : name);
+}
+
+bool UpdateAsyncLoads(Uint32 budget_ms) {
+  return ResourceManager::GetInstance().UpdateAsyncLoads(budget_ms);
+}
+
+void WaitForAsyncLoads() {
+  ResourceManager::GetInstance().WaitForAsyncLoads();
+}
+
+bool IsLoaded(TextureHandle handle) {
+  const auto* entry = ResourceManager::GetInstance().GetTexture(handle);
+  return entry && entry->texture;
+}
+
+LoadingProgress GetLoadingProgress() {
+  return ResourceManager::GetInstance().GetLoadingProgress();
+}
+
+std::vector<TextureHandle> LoadPackedResources(
+    const std::vector<PackedResource>& resources,
+    int page_size) {
+  // One pixel of transparent padding keeps filtering from bleeding
+  // neighbours into a sprite's edges.
+  constexpr int kPadding = 1;
+
+  struct Image {
+    std::size_t index;
+    SDL_Surface* surface;
+    std::optional<RectPacker::Position> position;
+    std::size_t page = 0;
+  };
+
+  std::vector<Image> images;
+  std::vector<TextureHandle> handles(resources.size());
+  auto free_surfaces = [&images] {
+    for (auto& image : images) {
+      if (image.surface)
+        SDL_FreeSurface(image.surface);
+    }
+  };
+
+  // Decode in parallel, so loading takes as long as the slowest image. The
+  // resource manager initializes SDL_image before the first decode.
+  auto& manager = ResourceManager::GetInstance();
+  std::vector<std::future<SDL_Surface*>> decoded;
+  for (const auto& resource : resources) {
+    decoded.push_back(std::async(std::launch::async, DecodeImage,
+                                 resource.path));
+  }
+  for (std::size_t i = 0; i < resources.size(); ++i) {
+    images.push_back({i, decoded[i].get(), std::nullopt});
+  }
+  for (std::size_t i = 0; i < resources.size(); ++i) {
+    if (!images[i].surface) {
+      free_surfaces();
+      throw std::invalid_argument("Can't find resource: " +
+                                  resources[i].path.string());
+    }
+  }
+
+  std::vector<Image*> packable;
+  for (auto& image : images) {
+    if (image.surface->w + kPadding <= page_size / 2 &&
+        image.surface->h + kPadding <= page_size / 2) {
+      packable.push_back(&image);
+    }
+  }
+  std::stable_sort(packable.begin(), packable.end(),
+                   [](const Image* lhs, const Image* rhs) {
+                     return lhs->surface->h > rhs->surface->h;
+                   });
+
+  std::vector<RectPacker> packers;
+  for (Image* image : packable) {
+    const int w = image->surface->w + kPadding;
+    const int h = image->surface->h + kPadding;
+    for (image->page = 0; image->page < packers.size(); ++image->page) {
+      image->position = packers[image->page].Insert(w, h);
+      if (image->position)
+        break;
+    }
+    if (!image->position) {
+      packers.emplace_back(page_size, page_size);
+      image->position = packers.back().Insert(w, h);
+    }
+  }
+
+  for (std::size_t page = 0; page < packers.size(); ++page) {
+    SDL_Surface* page_surface = SDL_CreateRGBSurfaceWithFormat(
+        0, page_size, page_size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!page_surface) {
+      free_surfaces();
+      throw std::runtime_error(std::string("Can't create atlas page: ") +
+                               SDL_GetError());
+    }
+    for (Image* image : packable) {
+      if (image->page != page)
+        continue;
+      SDL_Rect dest = {image->position->x, image->position->y,
+                       image->surface->w, image->surface->h};
+      SDL_SetSurfaceBlendMode(image->surface, SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(image->surface, nullptr, page_surface, &dest);
+    }
+
+    SDL_Texture* texture =
+        SDL_CreateTextureFromSurface(GetRenderer(), page_surface);
+    SDL_FreeSurface(page_surface);
+    if (!texture) {
+      free_surfaces();
+      throw std::runtime_error(std::string("Can't create atlas page: ") +
+                               SDL_GetError());
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    manager.AddPage(texture);
+
+    for (Image* image : packable) {
+      if (image->page != page)
+        continue;
+      const SDL_Rect source = {image->position->x, image->position->y,
+                               image->surface->w, image->surface->h};
+      handles[image->index] = manager.Register(
+          ResourceName(resources[image->index]), texture, source, false);
+    }
+  }
+
+  for (auto& image : images) {
+    if (image.position)
+      continue;
+    SDL_Texture* texture =
+        SDL_CreateTextureFromSurface(GetRenderer(), image.surface);
+    if (!texture) {
+      free_surfaces();
+      throw std::runtime_error(std::string("Can't create texture: ") +
+                               SDL_GetError());
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    handles[image.index] =
+        manager.Register(ResourceName(resources[image.index]), texture,
+                         {0, 0, image.surface->w, image.surface->h}, true);
+  }
+
+  free_surfaces();
+  return handles;
 }
 
 void DrawImage(const std::string& name, int x, int y, int w, int h) {
-  auto* texture = GetTexture(name);
+  DrawImage(GetTextureHandle(name), x, y, w, h);
+}
+
+void DrawImage(TextureHandle handle, int x, int y, int w, int h) {
+  const auto& entry = GetTextureEntry(handle);
+  if (!entry.texture)
+    return;
   SDL_Rect rect = {x, y, w, h};
   if (w == 0 || h == 0) {
-    SDL_QueryTexture(texture, nullptr, nullptr, &rect.w, &rect.h);
+    rect.w = entry.source.w;
+    rect.h = entry.source.h;
   }
 
-  SDL_RenderCopy(GetRenderer(), texture, nullptr, &rect);
+  GetSpriteBatch().Draw(entry.texture, &entry.source, rect);
 }
 
 void DrawImageFromAtlas(const std::string& name,
@@ -137,45 +652,62 @@ void DrawImageFromAtlas(const std::string& name,
                         int y,
                         int w,
                         int h) {
-  const auto& atlas = ResourceManager::GetInstance().GetAtlas(name);
-  const auto& al = atlas.GetAnimationLine(line);
-  auto* texture = GetTexture(atlas.GetName());
-
-  SDL_Rect source;
-  source.y = al.y_offset;
-  source.h = al.frame_height;
-  source.w = al.frame_width;
-  if (!al.with_reverse) {
-    source.x = (frame % al.frames_count) * al.frame_width;
-  } else {
-    int frame_num = frame % (al.frames_count * 2 - 2);
-    if (frame_num >= al.frames_count) {
-      frame_num = al.frames_count - (frame_num - al.frames_count) - 2;
-    }
-    source.x = frame_num * al.frame_width;
-  }
+  DrawAnimationFrame(GetAnimation(name, line), frame, x, y, w, h);
+}
 
-  if (w == 0 || h == 0) {
-    w = source.w;
-    h = source.h;
-  }
+void DrawImageFromAtlas(TextureHandle handle,
+                        const std::string& line,
+                        int frame,
+                        int x,
+                        int y,
+                        int w,
+                        int h) {
+  DrawAnimationFrame(GetAnimation(handle, line), frame, x, y, w, h);
+}
 
-  SDL_RenderCopy(GetRenderer(), texture, &source, MakeRect(x, y, w, h));
+AnimationHandle GetAnimation(const std::string& atlas,
+                             const std::string& line) {
+  return GetAnimation(GetTextureHandle(atlas), line);
 }
 
-void DrawImageFromAtlas(const std::string& name,
+AnimationHandle GetAnimation(TextureHandle atlas, const std::string& line) {
+  return ResourceManager::GetInstance().GetAnimation(atlas, line);
+}
+
+void DrawAnimationFrame(AnimationHandle animation,
+                        int frame,
                         int x,
                         int y,
                         int w,
-                        int h,
-                        int atlas_x,
-                        int atlas_y,
-                        int atlas_w,
-                        int atlas_h) {
-  auto* texture = GetTexture(name);
-  SDL_RenderCopy(GetRenderer(), texture,
-                 MakeRect(atlas_x, atlas_y, atlas_w, atlas_h),
-                 MakeRect(x, y, w, h));
+                        int h) {
+  if (!animation.IsValid())
+    return;
+
+  const auto& f = ResourceManager::GetInstance().GetFrame(
+      animation.first_frame +
+      static_cast<std::uint32_t>(frame) % animation.frame_count);
+  SDL_Texture* texture = GetTexture(f.texture);
+  if (!texture)
+    return;
+
+  if (w == 0 || h == 0) {
+    w = f.source.w;
+    h = f.source.h;
+  }
+  GetSpriteBatch().Draw(texture, &f.source, {x, y, w, h});
+}
+
+SpriteBatch& GetSpriteBatch() {
+  static SpriteBatch batch;
+  return batch;
+}
+
+void SetDrawLayer(int layer) {
+  GetSpriteBatch().SetLayer(layer);
+}
+
+void FlushSprites() {
+  GetSpriteBatch().Flush(GetRenderer());
 }
 
 void FreeAllResources() {
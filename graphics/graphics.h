@@ -2,23 +2,41 @@
 
 #include <SDL.h>
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
+#include <vector>
 #include "atlas.h"
+#include "sprite_batch.h"
+#include "texture_handle.h"
 
 
 namespace render {
 
 class RenderWindow {
  public:
-  RenderWindow(int width, int height);
+  enum class Mode {
+    kWindowed,
+    // Needs no display: a hidden window on SDL's dummy video driver and a
+    // software renderer drawing into an offscreen texture.
+    kHeadless,
+  };
+
+  // A GAMEBASE_HEADLESS environment variable set to anything but 0 forces
+  // Mode::kHeadless.
+  RenderWindow(int width, int height, Mode mode = Mode::kWindowed);
   virtual ~RenderWindow();
 
+  bool IsHeadless() const;
+
  public:
   friend SDL_Renderer* GetRenderer();
 
   int width_ = 0;
   int height_ = 0;
+  Mode mode_ = Mode::kWindowed;
+  // Render target of a headless window.
+  SDL_Texture* offscreen_target_ = nullptr;
   static SDL_Window* sdl_window_;
   static SDL_Renderer* sdl_renderer_;
 };
@@ -26,13 +44,58 @@ class RenderWindow {
 SDL_Renderer* GetRenderer();
 
 SDL_Texture* GetTexture(const std::string& name);
+SDL_Texture* GetTexture(TextureHandle handle);
+TextureHandle GetTextureHandle(const std::string& name);
+const std::string& GetTextureName(TextureHandle handle);
+// Part of GetTexture(handle) holding the image. Packed images share their
+// texture with others.
+SDL_Rect GetTextureRect(TextureHandle handle);
+
+TextureHandle LoadResource(const std::filesystem::path& path,
+                           const std::string& name = {});
+
+// Decodes the image on a background thread. The handle is valid at once;
+// until the texture is uploaded by UpdateAsyncLoads() drawing it draws
+// nothing.
+TextureHandle LoadResourceAsync(const std::filesystem::path& path,
+                                const std::string& name = {});
+// Uploads decoded images to textures on the render thread, for roughly
+// |budget_ms| per call. Returns true when no load is pending.
+bool UpdateAsyncLoads(Uint32 budget_ms = 2);
+void WaitForAsyncLoads();
+bool IsLoaded(TextureHandle handle);
+
+struct LoadingProgress {
+  float GetFraction() const {
+    return total == 0 ? 1.f : static_cast<float>(loaded) / total;
+  }
+
+  std::size_t loaded = 0;
+  std::size_t total = 0;
+};
+// Asynchronous loads uploaded so far out of all started ones.
+LoadingProgress GetLoadingProgress();
+
+struct PackedResource {
+  std::filesystem::path path;
+  // Defaults to the file name, as for LoadResource().
+  std::string name;
+};
 
-std::string LoadResource(const std::filesystem::path& path,
-                         const std::string& name = {});
+std::string ResourceName(const PackedResource& resource);
+
+// Loads |resources| and packs the ones fitting in a quarter of a page into
+// shared |page_size| square textures, so that drawing them needs few texture
+// switches. Larger images get their own texture. Handles are returned in the
+// order of |resources| and drawing them by name or handle is unchanged.
+std::vector<TextureHandle> LoadPackedResources(
+    const std::vector<PackedResource>& resources,
+    int page_size = 1024);
 void BakeAtlas(class Atlas& atlas);
 void FreeAllResources();
 
 void DrawImage(const std::string& name, int x, int y, int w = 0, int h = 0);
+void DrawImage(TextureHandle handle, int x, int y, int w = 0, int h = 0);
 void DrawImageFromAtlas(const std::string& name,
                         const std::string& line,
                         int frame,
@@ -40,6 +103,31 @@ void DrawImageFromAtlas(const std::string& name,
                         int y,
                         int w = 0,
                         int h = 0);
+void DrawImageFromAtlas(TextureHandle handle,
+                        const std::string& line,
+                        int frame,
+                        int x,
+                        int y,
+                        int w = 0,
+                        int h = 0);
+
+// Draw calls are queued in the sprite batch and submitted by FlushSprites(),
+// which the application calls before presenting a frame.
+SpriteBatch& GetSpriteBatch();
+void SetDrawLayer(int layer);
+void FlushSprites();
+
+// Resolves an animation line of a baked atlas once, so that drawing its
+// frames is a single table lookup.
+AnimationHandle GetAnimation(const std::string& atlas, const std::string& line);
+AnimationHandle GetAnimation(TextureHandle atlas, const std::string& line);
+// |frame| counts up freely, it wraps around the line's sequence.
+void DrawAnimationFrame(AnimationHandle animation,
+                        int frame,
+                        int x,
+                        int y,
+                        int w = 0,
+                        int h = 0);
 
 const SDL_Rect* MakeRect(int x, int y, int w, int h);
 
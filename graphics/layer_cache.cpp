@@ -0,0 +1,95 @@
+#include "layer_cache.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "graphics.h"
+#include "sprite_batch.h"
+
+namespace render {
+
+LayerCache::~LayerCache() {
+  if (cache_)
+    SDL_DestroyTexture(cache_);
+}
+
+void LayerCache::SetLayer(int order, Painter painter) {
+  layers_[order] = std::move(painter);
+  dirty_ = true;
+}
+
+void LayerCache::RemoveLayer(int order) {
+  if (layers_.erase(order))
+    dirty_ = true;
+}
+
+bool LayerCache::IsEmpty() const {
+  return layers_.empty();
+}
+
+void LayerCache::Invalidate() {
+  // The next Draw() creates a new target, in case the old one was lost with
+  // its content.
+  if (cache_) {
+    SDL_DestroyTexture(cache_);
+    cache_ = nullptr;
+  }
+  dirty_ = true;
+}
+
+void LayerCache::Draw() {
+  SDL_Renderer* renderer = GetRenderer();
+
+  int width = 0;
+  int height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  if (!cache_ || width != width_ || height != height_) {
+    if (cache_)
+      SDL_DestroyTexture(cache_);
+    cache_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                               SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!cache_)
+      throw std::runtime_error(std::string("Can't create layer cache: ") +
+                               SDL_GetError());
+    SDL_SetTextureBlendMode(cache_, SDL_BLENDMODE_NONE);
+    width_ = width;
+    height_ = height;
+    dirty_ = true;
+  }
+
+  if (GetLoadingProgress().loaded != loaded_)
+    dirty_ = true;
+
+  if (dirty_)
+    Rebuild(renderer);
+
+  GetSpriteBatch().Draw(cache_, nullptr, {0, 0, width_, height_});
+}
+
+void LayerCache::Rebuild(SDL_Renderer* renderer) {
+  // Sprites already queued for this frame wait in |frame| while the layers
+  // are painted through the shared batch.
+  SpriteBatch frame;
+  std::swap(frame, GetSpriteBatch());
+
+  SDL_Texture* target = SDL_GetRenderTarget(renderer);
+  SDL_SetRenderTarget(renderer, cache_);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+  SDL_RenderClear(renderer);
+
+  int layer = 0;
+  for (auto& [order, painter] : layers_) {
+    SetDrawLayer(layer++);
+    painter();
+  }
+  FlushSprites();
+
+  SDL_SetRenderTarget(renderer, target);
+  std::swap(frame, GetSpriteBatch());
+
+  loaded_ = GetLoadingProgress().loaded;
+  dirty_ = false;
+}
+
+}  // namespace render
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+
+namespace render {
+
+// Static layers, such as a background and overlays on top of it, composited
+// once into a render target the size of the renderer output. A frame then
+// draws a single opaque full-screen sprite instead of every layer blended.
+//
+// The composite is rebuilt on the next Draw() after a layer changes, the
+// output is resized, an asynchronous texture load completes, or Invalidate()
+// is called.
+class LayerCache {
+ public:
+  // Draws the layer with the usual DrawImage() API, in output coordinates.
+  using Painter = std::function<void()>;
+
+  LayerCache() = default;
+  LayerCache(const LayerCache&) = delete;
+  LayerCache& operator=(const LayerCache&) = delete;
+  ~LayerCache();
+
+  // Layers are composited by increasing |order|, replacing any layer with
+  // the same order.
+  void SetLayer(int order, Painter painter);
+  void RemoveLayer(int order);
+  bool IsEmpty() const;
+  // Needed after SDL_RENDER_TARGETS_RESET, which loses the composite.
+  // Recreates the render target too.
+  void Invalidate();
+
+  // Queues the composite on the sprite batch at the current draw layer. It is
+  // opaque, so it covers everything drawn below it.
+  void Draw();
+
+ private:
+  void Rebuild(SDL_Renderer* renderer);
+
+  std::map<int, Painter> layers_;
+  SDL_Texture* cache_ = nullptr;
+  int width_ = 0;
+  int height_ = 0;
+  std::size_t loaded_ = 0;
+  bool dirty_ = true;
+};
+
+}  // namespace render
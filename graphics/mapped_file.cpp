@@ -0,0 +1,94 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace render {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    throw std::invalid_argument("Can't open " + path.string());
+  }
+
+  LARGE_INTEGER size;
+  GetFileSizeEx(file_, &size);
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  if (size_ == 0)
+    return;
+
+  mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_)
+    data_ = static_cast<const std::uint8_t*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    if (mapping_)
+      CloseHandle(mapping_);
+    CloseHandle(file_);
+    throw std::runtime_error("Can't map " + path.string());
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    UnmapViewOfFile(data_);
+  if (mapping_)
+    CloseHandle(mapping_);
+  if (file_)
+    CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::invalid_argument("Can't open " + path.string());
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Can't stat " + path.string());
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ == 0) {
+    close(fd);
+    return;
+  }
+
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Can't map " + path.string());
+  data_ = static_cast<const std::uint8_t*>(data);
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    munmap(const_cast<std::uint8_t*>(data_), size_);
+}
+
+#endif
+
+const std::uint8_t* MappedFile::GetData() const {
+  return data_;
+}
+
+std::size_t MappedFile::GetSize() const {
+  return size_;
+}
+
+}  // namespace render
@@ -0,0 +1,103 @@
+#include "rect_packer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace render {
+
+RectPacker::RectPacker(int width, int height)
+    : width_(width), height_(height) {
+  if (width <= 0 || height <= 0)
+    throw std::invalid_argument("Packer page must have a positive size");
+  skyline_.push_back({0, 0, width});
+}
+
+std::optional<RectPacker::Position> RectPacker::Insert(int width,
+                                                       int height) {
+  if (width <= 0 || height <= 0)
+    throw std::invalid_argument("Packed rectangle must have a positive size");
+
+  std::optional<std::size_t> best;
+  int best_y = 0;
+  int best_width = 0;
+  for (std::size_t i = 0; i < skyline_.size(); ++i) {
+    const auto y = Fit(i, width, height);
+    if (!y)
+      continue;
+    if (!best || *y < best_y ||
+        (*y == best_y && skyline_[i].width < best_width)) {
+      best = i;
+      best_y = *y;
+      best_width = skyline_[i].width;
+    }
+  }
+
+  if (!best)
+    return std::nullopt;
+
+  const Position position{skyline_[*best].x, best_y};
+  AddSkyline(*best, position.x, position.y, width, height);
+  return position;
+}
+
+int RectPacker::GetWidth() const {
+  return width_;
+}
+
+int RectPacker::GetHeight() const {
+  return height_;
+}
+
+std::optional<int> RectPacker::Fit(std::size_t index,
+                                   int width,
+                                   int height) const {
+  const int x = skyline_[index].x;
+  if (x + width > width_)
+    return std::nullopt;
+
+  int y = 0;
+  for (int remaining = width; remaining > 0; ++index) {
+    if (index >= skyline_.size())
+      return std::nullopt;
+    y = std::max(y, skyline_[index].y);
+    if (y + height > height_)
+      return std::nullopt;
+    remaining -= skyline_[index].width;
+  }
+  return y;
+}
+
+void RectPacker::AddSkyline(std::size_t index,
+                            int x,
+                            int y,
+                            int width,
+                            int height) {
+  skyline_.insert(skyline_.begin() + index, {x, y + height, width});
+
+  // Cut the segments now covered by the new one.
+  for (std::size_t i = index + 1; i < skyline_.size();) {
+    const Segment& previous = skyline_[i - 1];
+    Segment& segment = skyline_[i];
+    const int overlap = previous.x + previous.width - segment.x;
+    if (overlap <= 0)
+      break;
+    if (overlap < segment.width) {
+      segment.x += overlap;
+      segment.width -= overlap;
+      break;
+    }
+    skyline_.erase(skyline_.begin() + i);
+  }
+
+  // Merge neighbours of the same height.
+  for (std::size_t i = 0; i + 1 < skyline_.size();) {
+    if (skyline_[i].y == skyline_[i + 1].y) {
+      skyline_[i].width += skyline_[i + 1].width;
+      skyline_.erase(skyline_.begin() + i + 1);
+    } else {
+      ++i;
+    }
+  }
+}
+
+}  // namespace render
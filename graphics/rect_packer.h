@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+namespace render {
+
+// Skyline bottom-left packer: places rectangles into a fixed size page,
+// each one at the lowest position along the current skyline where it fits.
+// Feed rectangles sorted by decreasing height for the tightest pages.
+class RectPacker {
+ public:
+  struct Position {
+    int x = 0;
+    int y = 0;
+  };
+
+  RectPacker(int width, int height);
+
+  // Returns where the |width| x |height| rectangle was placed, or nothing
+  // when the page has no room for it.
+  std::optional<Position> Insert(int width, int height);
+
+  int GetWidth() const;
+  int GetHeight() const;
+
+ private:
+  struct Segment {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+  };
+
+  // Height the rectangle would rest at when placed on segment |index|, or
+  // nothing when it would leave the page.
+  std::optional<int> Fit(std::size_t index, int width, int height) const;
+  void AddSkyline(std::size_t index, int x, int y, int width, int height);
+
+  int width_ = 0;
+  int height_ = 0;
+  std::vector<Segment> skyline_;
+};
+
+}  // namespace render
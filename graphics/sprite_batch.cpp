@@ -0,0 +1,121 @@
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace render {
+
+void SpriteBatch::SetLayer(int layer) {
+  layer_ = layer;
+}
+
+int SpriteBatch::GetLayer() const {
+  return layer_;
+}
+
+void SpriteBatch::SetCullRect(const SDL_Rect* rect) {
+  cull_ = rect != nullptr;
+  if (rect)
+    cull_rect_ = *rect;
+}
+
+void SpriteBatch::Draw(SDL_Texture* texture,
+                       const SDL_Rect* source,
+                       const SDL_Rect& dest) {
+  if (cull_ && (dest.x >= cull_rect_.x + cull_rect_.w ||
+                dest.y >= cull_rect_.y + cull_rect_.h ||
+                dest.x + dest.w <= cull_rect_.x ||
+                dest.y + dest.h <= cull_rect_.y)) {
+    return;
+  }
+
+  Sprite sprite;
+  sprite.layer = layer_;
+  sprite.texture = texture;
+  sprite.dest = dest;
+  if (source) {
+    sprite.source = *source;
+    sprite.whole_texture = false;
+  }
+  sprites_.push_back(sprite);
+}
+
+void SpriteBatch::Flush(SDL_Renderer* renderer) {
+  if (sprites_.empty())
+    return;
+
+  std::stable_sort(sprites_.begin(), sprites_.end(),
+                   [](const Sprite& lhs, const Sprite& rhs) {
+                     if (lhs.layer != rhs.layer)
+                       return lhs.layer < rhs.layer;
+                     return std::less<SDL_Texture*>()(lhs.texture,
+                                                      rhs.texture);
+                   });
+
+  for (auto begin = sprites_.begin(); begin != sprites_.end();) {
+    auto end = std::find_if(begin, sprites_.end(), [begin](const Sprite& s) {
+      return s.layer != begin->layer || s.texture != begin->texture;
+    });
+
+    int texture_w = 0;
+    int texture_h = 0;
+    SDL_QueryTexture(begin->texture, nullptr, nullptr, &texture_w, &texture_h);
+
+    // SDL_RenderGeometry() modulates by the vertex color only, so the texture
+    // color and alpha mods are copied into the vertices, as SDL_RenderCopy()
+    // applies them.
+    SDL_Color color = {255, 255, 255, 255};
+    SDL_GetTextureColorMod(begin->texture, &color.r, &color.g, &color.b);
+    SDL_GetTextureAlphaMod(begin->texture, &color.a);
+
+    vertices_.clear();
+    indices_.clear();
+    for (auto it = begin; it != end; ++it) {
+      AppendQuad(*it, texture_w, texture_h, color);
+    }
+    SDL_RenderGeometry(renderer, begin->texture, vertices_.data(),
+                       static_cast<int>(vertices_.size()), indices_.data(),
+                       static_cast<int>(indices_.size()));
+    begin = end;
+  }
+
+  sprites_.clear();
+}
+
+bool SpriteBatch::IsEmpty() const {
+  return sprites_.empty();
+}
+
+void SpriteBatch::AppendQuad(const Sprite& sprite,
+                             int texture_w,
+                             int texture_h,
+                             SDL_Color color) {
+  float u0 = 0.f;
+  float v0 = 0.f;
+  float u1 = 1.f;
+  float v1 = 1.f;
+  if (!sprite.whole_texture && texture_w > 0 && texture_h > 0) {
+    u0 = static_cast<float>(sprite.source.x) / texture_w;
+    v0 = static_cast<float>(sprite.source.y) / texture_h;
+    u1 = static_cast<float>(sprite.source.x + sprite.source.w) / texture_w;
+    v1 = static_cast<float>(sprite.source.y + sprite.source.h) / texture_h;
+  }
+
+  const float x0 = static_cast<float>(sprite.dest.x);
+  const float y0 = static_cast<float>(sprite.dest.y);
+  const float x1 = static_cast<float>(sprite.dest.x + sprite.dest.w);
+  const float y1 = static_cast<float>(sprite.dest.y + sprite.dest.h);
+
+  const int first = static_cast<int>(vertices_.size());
+  vertices_.push_back({{x0, y0}, color, {u0, v0}});
+  vertices_.push_back({{x1, y0}, color, {u1, v0}});
+  vertices_.push_back({{x1, y1}, color, {u1, v1}});
+  vertices_.push_back({{x0, y1}, color, {u0, v1}});
+
+  const int quad[] = {0, 1, 2, 2, 3, 0};
+  for (int i : quad) {
+    indices_.push_back(first + i);
+  }
+}
+
+}  // namespace render
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+
+namespace render {
+
+// Collects textured quads during a frame and submits them with a few
+// SDL_RenderGeometry calls instead of one SDL_RenderCopy per sprite.
+//
+// Sprites are drawn ordered by layer. Inside a layer they are grouped by
+// texture, keeping the submission order of sprites sharing a texture, so
+// overlapping sprites that need a strict order must use different layers.
+class SpriteBatch {
+ public:
+  void SetLayer(int layer);
+  int GetLayer() const;
+  // Draw() drops sprites lying entirely outside |rect|, nullptr draws all.
+  void SetCullRect(const SDL_Rect* rect);
+
+  // |source| is the part of |texture| to draw, nullptr for the whole texture.
+  void Draw(SDL_Texture* texture, const SDL_Rect* source, const SDL_Rect& dest);
+  void Flush(SDL_Renderer* renderer);
+
+  bool IsEmpty() const;
+
+ private:
+  struct Sprite {
+    int layer = 0;
+    SDL_Texture* texture = nullptr;
+    SDL_Rect source = {};
+    SDL_Rect dest = {};
+    bool whole_texture = true;
+  };
+
+  void AppendQuad(const Sprite& sprite,
+                  int texture_w,
+                  int texture_h,
+                  SDL_Color color);
+
+  int layer_ = 0;
+  bool cull_ = false;
+  SDL_Rect cull_rect_ = {};
+  std::vector<Sprite> sprites_;
+  std::vector<SDL_Vertex> vertices_;
+  std::vector<int> indices_;
+};
+
+}  // namespace render
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+
+namespace render {
+
+// Compact reference to a loaded texture. Resolving it is an array index into
+// the resource manager, so it is meant for the per-frame draw path, while the
+// name based API stays available for setup code. Handles stay valid until
+// FreeAllResources(); loading a resource under an existing name keeps its
+// handle.
+struct TextureHandle {
+  static constexpr std::uint32_t kInvalidIndex = ~std::uint32_t{0};
+
+  bool IsValid() const { return index != kInvalidIndex; }
+
+  bool operator==(const TextureHandle& o) const { return index == o.index; }
+  bool operator!=(const TextureHandle& o) const { return index != o.index; }
+
+  std::uint32_t index = kInvalidIndex;
+};
+
+// Baked animation line of an atlas: a range in the resource manager's flat
+// table of frame rectangles, with ping-pong sequences already expanded.
+// Valid until FreeAllResources().
+struct AnimationHandle {
+  bool IsValid() const { return frame_count != 0; }
+
+  std::uint32_t first_frame = 0;
+  std::uint32_t frame_count = 0;
+};
+
+}  // namespace render
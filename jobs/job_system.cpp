@@ -0,0 +1,148 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+namespace jobs {
+
+namespace {
+
+// Set on the threads of a pool, see JobSystem::GetCurrentWorker().
+thread_local const JobSystem* current_system = nullptr;
+thread_local std::size_t current_worker = 0;
+
+}  // namespace
+
+JobSystem::JobSystem(unsigned thread_count) {
+  if (thread_count == 0) {
+    const unsigned hardware = std::thread::hardware_concurrency();
+    thread_count = hardware > 1 ? hardware - 1 : 0;
+  }
+
+  for (unsigned i = 0; i <= thread_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (unsigned i = 1; i <= thread_count; ++i) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+unsigned JobSystem::GetThreadCount() const {
+  return static_cast<unsigned>(threads_.size());
+}
+
+std::size_t JobSystem::GetCurrentWorker() const {
+  return current_system == this ? current_worker : 0;
+}
+
+void JobSystem::Worker::PushBack(const Task& task) {
+  if (size == tasks.size()) {
+    std::vector<Task> grown(std::max<std::size_t>(64, tasks.size() * 2));
+    for (std::size_t i = 0; i < size; ++i) {
+      grown[i] = tasks[(front + i) & (tasks.size() - 1)];
+    }
+    tasks.swap(grown);
+    front = 0;
+  }
+  tasks[(front + size++) & (tasks.size() - 1)] = task;
+}
+
+bool JobSystem::Worker::PopBack(Task& task) {
+  if (size == 0)
+    return false;
+  task = tasks[(front + --size) & (tasks.size() - 1)];
+  return true;
+}
+
+bool JobSystem::Worker::PopFront(Task& task) {
+  if (size == 0)
+    return false;
+  task = tasks[front];
+  front = (front + 1) & (tasks.size() - 1);
+  --size;
+  return true;
+}
+
+void JobSystem::Push(const Task& task) {
+  // Counted before it becomes visible, so a thief never drops the counter
+  // below zero.
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    ++queued_;
+  }
+  Worker& worker = *workers_[GetCurrentWorker()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.PushBack(task);
+  }
+  wake_.notify_one();
+}
+
+bool JobSystem::TryPop(std::size_t worker, Task& task) {
+  Worker& w = *workers_[worker];
+  std::lock_guard<std::mutex> lock(w.mutex);
+  return w.PopBack(task);
+}
+
+bool JobSystem::TrySteal(std::size_t thief, Task& task) {
+  for (std::size_t i = 1; i < workers_.size(); ++i) {
+    Worker& victim = *workers_[(thief + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.PopFront(task))
+      return true;
+  }
+  return false;
+}
+
+bool JobSystem::TryRunOne(std::size_t worker) {
+  Task task;
+  if (!TryPop(worker, task) && !TrySteal(worker, task))
+    return false;
+
+  --queued_;
+  try {
+    task.run(task.callback, task.chunk, task.begin, task.end);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(task.batch->mutex);
+    if (!task.batch->error)
+      task.batch->error = std::current_exception();
+  }
+  task.batch->pending.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void JobSystem::Wait(Batch& batch) {
+  const std::size_t worker = GetCurrentWorker();
+  while (batch.pending.load(std::memory_order_acquire) != 0) {
+    if (!TryRunOne(worker))
+      std::this_thread::yield();
+  }
+  if (batch.error)
+    std::rethrow_exception(batch.error);
+}
+
+void JobSystem::WorkerLoop(std::size_t worker) {
+  current_system = this;
+  current_worker = worker;
+  for (;;) {
+    if (TryRunOne(worker))
+      continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    if (stop_)
+      return;
+  }
+}
+
+}  // namespace jobs
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jobs {
+
+// Fixed pool of worker threads with a work-stealing deque per worker. Jobs
+// are pushed to the deque of the submitting thread; every worker takes jobs
+// from the back of its own deque and steals from the front of the others
+// when it runs dry. A thread waiting for its jobs runs queued jobs too, so
+// waiting never blocks a core.
+//
+// Tasks are plain structs pointing at the caller's callback and deques are
+// ring buffers that keep their storage, so once they have grown to the peak
+// number of queued chunks, submitting work doesn't allocate.
+class JobSystem {
+ public:
+  // |thread_count| of 0 uses one worker per hardware thread besides the
+  // calling one.
+  explicit JobSystem(unsigned thread_count = 0);
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  ~JobSystem();
+
+  unsigned GetThreadCount() const;
+
+  // Splits [0, count) into consecutive chunks of |grain| items and calls
+  // |f(chunk, begin, end)| for each of them in parallel, returning when all
+  // are done. Chunk boundaries only depend on |count| and |grain|, so
+  // per-chunk results merged in chunk order don't depend on the number of
+  // threads. If a chunk throws, the first exception is rethrown once every
+  // chunk has finished.
+  template <typename F>
+  void ParallelFor(std::size_t count, std::size_t grain, F&& f);
+
+  static std::size_t GetChunkCount(std::size_t count, std::size_t grain) {
+    return grain == 0 ? 0 : (count + grain - 1) / grain;
+  }
+
+ private:
+  // Jobs of one ParallelFor() call.
+  struct Batch {
+    explicit Batch(std::size_t count) : pending(count) {}
+
+    std::atomic<std::size_t> pending;
+    std::mutex mutex;
+    std::exception_ptr error;
+  };
+
+  // One chunk of a ParallelFor(). |callback| is the caller's functor, alive
+  // until the batch is done.
+  struct Task {
+    void (*run)(void* callback,
+                std::size_t chunk,
+                std::size_t begin,
+                std::size_t end) = nullptr;
+    void* callback = nullptr;
+    std::size_t chunk = 0;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    Batch* batch = nullptr;
+  };
+
+  // Double-ended ring buffer of tasks, guarded by |mutex|.
+  struct Worker {
+    void PushBack(const Task& task);
+    bool PopBack(Task& task);
+    bool PopFront(Task& task);
+
+    std::mutex mutex;
+    // Power of two size, grown when full.
+    std::vector<Task> tasks;
+    std::size_t front = 0;
+    std::size_t size = 0;
+  };
+
+  // Deque of the calling thread: its own for a worker, 0 otherwise.
+  std::size_t GetCurrentWorker() const;
+
+  void Push(const Task& task);
+  bool TryPop(std::size_t worker, Task& task);
+  bool TrySteal(std::size_t thief, Task& task);
+  bool TryRunOne(std::size_t worker);
+  void Wait(Batch& batch);
+  void WorkerLoop(std::size_t worker);
+
+  // Index 0 is the deque of the threads outside the pool calling into the
+  // system.
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<std::size_t> queued_{0};
+  bool stop_ = false;
+};
+
+template <typename F>
+void JobSystem::ParallelFor(std::size_t count, std::size_t grain, F&& f) {
+  const std::size_t chunks = GetChunkCount(count, grain);
+  if (chunks == 0)
+    return;
+
+  if (chunks == 1 || threads_.empty()) {
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+      f(chunk, chunk * grain, std::min(count, (chunk + 1) * grain));
+    }
+    return;
+  }
+
+  using Callback = std::remove_reference_t<F>;
+  Batch batch(chunks);
+  Task task;
+  task.run = [](void* callback, std::size_t chunk, std::size_t begin,
+                std::size_t end) {
+    (*static_cast<Callback*>(callback))(chunk, begin, end);
+  };
+  task.callback = const_cast<void*>(static_cast<const void*>(&f));
+  task.batch = &batch;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    task.chunk = chunk;
+    task.begin = chunk * grain;
+    task.end = std::min(count, (chunk + 1) * grain);
+    Push(task);
+  }
+  Wait(batch);
+}
+
+}  // namespace jobs
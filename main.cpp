@@ -1,62 +1,180 @@
 #include "app/baseapp.h"
+#include "graphics/asset_pack.h"
+#include "jobs/job_system.h"
+#include "ztyp/ship_store.h"
 #include "ztyp/ztyp.h"
 
+#include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Ships were tuned for a step of 0.1 per 60 Hz frame.
+constexpr float kShipTimeScale = 6.f;
+constexpr std::size_t kMaxShipsPerType = 4096;
+constexpr int kWindowSize = 800;
+// Upward speed of the rockets fired from the bottom of the window.
+constexpr float kRocketSpeed = 20.f;
+constexpr int kRocketSize = 16;
+constexpr float kEmpRadius = 100.f;
+// Ships and rockets farther than this outside the window are removed.
+constexpr float kDespawnMargin = 64.f;
+// Opacity of the gradient over the stars.
+constexpr Uint8 kGradientAlpha = 96;
+// Built by the assets target, see CMakeLists.txt.
+constexpr char kAssetPack[] = "assets.pak";
+
+}  // namespace
 
 class GameApp : public app::GameApp {
  public:
-  GameApp(int w, int h)
-      : app::GameApp(w, h) {
+  GameApp(int w, int h, Mode mode)
+      : app::GameApp(w, h, mode) {
   }
 
  private:
 
   void Initialize() override {
-    render::LoadResource("resources/images/apple.png", "apple");
-    render::LoadResource("resources/images/stars.jpg", "stars");
-    render::LoadResource("resources/images/gradient.png", "gradient");
-    render::LoadResource("resources/images/mother.png", "mother");
-
-    space_ships_.push_back(new zt::SmallShip("abc", {10, 10}, {0,0}));
-    space_ships_.push_back(new zt::SmallShip("abc", {100, 20}, {0,1}));
-    space_ships_.push_back(new zt::SpamShip("abc", {200, 10}, {0,0}));
-    space_ships_.push_back(new zt::SmallShip("abc", {220, 40}, {0,0}));
-    space_ships_.push_back(new zt::SmallShip("abc", {300, 50}, {0,0}));
+    // Either way the textures are named after their files.
+    if (std::filesystem::exists(kAssetPack)) {
+      render::LoadAssetPack(kAssetPack);
+      stars_ = render::GetTextureHandle("stars.jpg");
+      gradient_ = render::GetTextureHandle("gradient.png");
+      mother_ = render::GetTextureHandle("mother.png");
+      rocket_ = render::GetTextureHandle("apple.png");
+    } else {
+      stars_ = render::LoadResourceAsync("resources/images/stars.jpg");
+      gradient_ = render::LoadResourceAsync("resources/images/gradient.png");
+      const auto sprites = render::LoadPackedResources({
+          {"resources/images/apple.png"},
+          {"resources/images/mother.png"},
+      });
+      rocket_ = sprites[0];
+      mother_ = sprites[1];
+    }
+
+    auto& background = GetBackgroundLayers();
+    background.SetLayer(0,
+                        [this] { render::DrawImage(stars_, 0, 0, 480, 720); });
+    background.SetLayer(1, [this] {
+      if (SDL_Texture* gradient = render::GetTexture(gradient_))
+        SDL_SetTextureAlphaMod(gradient, kGradientAlpha);
+      render::DrawImage(gradient_, 0, 0, kWindowSize, kWindowSize);
+    });
+
+    ships_.Reserve(kMaxShipsPerType);
+    const zt::Bounds world{{0, 0}, {kWindowSize, kWindowSize}};
+    ships_.SetDespawnBounds(world.Expanded(kDespawnMargin));
+    ships_.Add(zt::ShipType::kSmall, {10, 10}, {0, 0});
+    ships_.Add(zt::ShipType::kSmall, {100, 20}, {0, 1});
+    ships_.Add(zt::ShipType::kSpam, {200, 10}, {0, 0});
+    ships_.Add(zt::ShipType::kSmall, {220, 40}, {0, 0});
+    ships_.Add(zt::ShipType::kSmall, {300, 50}, {0, 0});
   }
 
+  // A left click fires a rocket up from the bottom of the window, a right
+  // click detonates an EMP at the cursor. Runs on the main thread, so the
+  // shots are handed to Update() under a lock.
   void ProcessInput(const Uint8* keyboard, const MouseState& mouse) override {
-  }
+    const Uint32 pressed = mouse.buttons & ~previous_buttons_;
+    previous_buttons_ = mouse.buttons;
+    if (!(pressed & (SDL_BUTTON_LMASK | SDL_BUTTON_RMASK)))
+      return;
 
-  void Render() override {
-    render::DrawImage("stars", 0, 0, 480, 720);
-    /// ?? entire alpha channel render::DrawImage("gradient",0, 0, 480, 720);
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    if (pressed & SDL_BUTTON_LMASK)
+      rocket_launches_.push_back(static_cast<float>(mouse.x));
+    if (pressed & SDL_BUTTON_RMASK) {
+      emp_detonations_.push_back(
+          {static_cast<float>(mouse.x), static_cast<float>(mouse.y)});
+    }
+  }
 
-    for (const zt::SpaceShip* ss: space_ships_) {
-      const zt::Vector2d& pos = ss->GetPosition();
-      render::DrawImage("mother", pos.x, pos.y);
+  void Render(float alpha) override {
+    render::SetDrawLayer(1);
+    for (std::size_t type = 0; type < zt::kShipTypeCount; ++type) {
+      const auto& ships = ships_.Get(static_cast<zt::ShipType>(type));
+      for (std::size_t i = 0; i < ships.Size(); ++i) {
+        const zt::Vector2d pos = ships.GetPosition(i, alpha);
+        render::DrawImage(mother_, pos.x, pos.y);
+      }
     }
+    ships_.ForEachRocket([this](zt::Handle<zt::Rocket>, const zt::Rocket& r) {
+      render::DrawImage(rocket_, r.GetPosition().x, r.GetPosition().y,
+                        kRocketSize, kRocketSize);
+    });
   }
 
-  void Update(Uint32 millis) override {
+  void WriteSnapshot(app::RenderSnapshot& snapshot) override {
+    for (std::size_t type = 0; type < zt::kShipTypeCount; ++type) {
+      const auto& ships = ships_.Get(static_cast<zt::ShipType>(type));
+      for (std::size_t i = 0; i < ships.Size(); ++i) {
+        snapshot.AddSprite(mother_, 1, ships.prev_x[i], ships.prev_y[i],
+                           ships.x[i], ships.y[i]);
+      }
+    }
+    ships_.ForEachRocket([&](zt::Handle<zt::Rocket>, const zt::Rocket& r) {
+      const zt::Vector2d& p = r.GetPosition();
+      snapshot.AddSprite(rocket_, 1, p.x, p.y, p.x, p.y, kRocketSize,
+                         kRocketSize);
+    });
+  }
 
-    std::vector<zt::SpaceShip*> new_ss;
-    for (zt::SpaceShip* ss: space_ships_) {
-      auto ns = ss->Update(0.1f);
-      new_ss.insert(new_ss.end(), ns.begin(), ns.end());
-      //space_ships_.insert(space_ships_.end(), new_ss.begin(), new_ss.end());
+  void Update(float dt) override {
+    {
+      std::lock_guard<std::mutex> lock(input_mutex_);
+      for (float x : rocket_launches_) {
+        ships_.LaunchRocket({x, kWindowSize}, {0, -kRocketSpeed});
+      }
+      rocket_launches_.clear();
+      for (const zt::Vector2d& p : emp_detonations_) {
+        ships_.DetonateEmp(p, kEmpRadius);
+      }
+      emp_detonations_.clear();
     }
-    space_ships_.insert(space_ships_.end(), new_ss.begin(), new_ss.end());
+    ships_.Update(dt * kShipTimeScale, &jobs_);
   }
 
+  render::TextureHandle stars_;
+  render::TextureHandle gradient_;
+  render::TextureHandle mother_;
+  render::TextureHandle rocket_;
   zt::Player player_;
-  std::vector<zt::SpaceShip*> space_ships_;
+  zt::ShipStore ships_;
+  jobs::JobSystem jobs_;
   int level_ = 1;
+
+  Uint32 previous_buttons_ = 0;
+  std::mutex input_mutex_;
+  std::vector<float> rocket_launches_;
+  std::vector<zt::Vector2d> emp_detonations_;
 };
 
 #undef main
-int main() {
+int main(int argc, char* argv[]) {
   try {
-    GameApp(800, 800).Run();
+    bool threaded = false;
+    auto mode = GameApp::Mode::kWindowed;
+    int frames = 0;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--threaded") {
+        threaded = true;
+      } else if (arg == "--headless") {
+        mode = GameApp::Mode::kHeadless;
+      } else if (arg == "--frames" && i + 1 < argc) {
+        frames = std::stoi(argv[++i]);
+      }
+    }
+
+    GameApp app(kWindowSize, kWindowSize, mode);
+    app.SetProfileOutput("profile.csv", "profile_trace.json");
+    app.SetThreadedSimulation(threaded);
+    app.SetFrameCountLimit(frames);
+    app.Run();
   } catch (std::exception& e) {
     std::cout << e.what() << std::endl;
   }
@@ -0,0 +1,224 @@
+#include "profiler.h"
+
+#include "../graphics/graphics.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace profiler {
+
+namespace {
+
+double ToMs(Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+double ToUs(Clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+std::ofstream OpenOutput(const std::filesystem::path& path) {
+  std::ofstream out(path);
+  if (!out)
+    throw std::invalid_argument("Can't write profile: " + path.string());
+  return out;
+}
+
+}  // namespace
+
+void Profiler::BeginFrame() {
+  Frame& frame = frames_[current_];
+  frame.index = frame_index_;
+  frame.events.clear();
+  in_frame_ = true;
+}
+
+void Profiler::EndFrame() {
+  if (!in_frame_)
+    return;
+
+  Frame& frame = frames_[current_];
+  frame.zone_totals.assign(zone_names_.size(), Clock::duration::zero());
+  for (const Event& e : frame.events) {
+    frame.zone_totals[e.zone] += e.duration;
+  }
+
+  in_frame_ = false;
+  ++frame_index_;
+  current_ = (current_ + 1) % kFrameHistory;
+  frame_count_ = std::min(frame_count_ + 1, kFrameHistory);
+}
+
+std::size_t Profiler::BeginZone(const char* name) {
+  if (!in_frame_)
+    return kNoEvent;
+
+  auto& events = frames_[current_].events;
+  Event event;
+  event.zone = FindZone(name);
+  event.start = Clock::now();
+  events.push_back(event);
+  return events.size() - 1;
+}
+
+void Profiler::EndZone(std::size_t event) {
+  if (!in_frame_ || event == kNoEvent)
+    return;
+
+  Event& e = frames_[current_].events[event];
+  e.duration = Clock::now() - e.start;
+}
+
+std::size_t Profiler::GetZoneCount() const {
+  return zone_names_.size();
+}
+
+const char* Profiler::GetZoneName(std::size_t zone) const {
+  return zone_names_.at(zone);
+}
+
+std::size_t Profiler::GetFrameCount() const {
+  return frame_count_;
+}
+
+double Profiler::GetZoneMs(std::size_t zone, std::size_t age) const {
+  const Frame& frame = GetFrame(age);
+  if (zone >= frame.zone_totals.size())
+    return 0;
+  return ToMs(frame.zone_totals[zone]);
+}
+
+ZoneStats Profiler::GetStats(std::size_t zone) const {
+  ZoneStats stats;
+  if (frame_count_ == 0)
+    return stats;
+
+  std::array<double, kFrameHistory> samples;
+  double sum = 0;
+  for (std::size_t age = 0; age < frame_count_; ++age) {
+    samples[age] = GetZoneMs(zone, age);
+    sum += samples[age];
+  }
+
+  const auto end = samples.begin() + frame_count_;
+  const std::size_t p99 = (frame_count_ - 1) * 99 / 100;
+  std::nth_element(samples.begin(), samples.begin() + p99, end);
+  stats.p99_ms = samples[p99];
+  stats.min_ms = *std::min_element(samples.begin(), end);
+  stats.avg_ms = sum / frame_count_;
+  return stats;
+}
+
+void Profiler::WriteCsv(const std::filesystem::path& path) const {
+  auto out = OpenOutput(path);
+  out << "frame";
+  for (const char* name : zone_names_) {
+    out << ',' << name << "_ms";
+  }
+  out << '\n';
+
+  for (std::size_t age = frame_count_; age-- > 0;) {
+    out << GetFrame(age).index;
+    for (std::size_t zone = 0; zone < zone_names_.size(); ++zone) {
+      out << ',' << GetZoneMs(zone, age);
+    }
+    out << '\n';
+  }
+}
+
+void Profiler::WriteChromeTrace(const std::filesystem::path& path) const {
+  auto out = OpenOutput(path);
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (std::size_t age = frame_count_; age-- > 0;) {
+    for (const Event& e : GetFrame(age).events) {
+      out << (first ? "\n" : ",\n") << "{\"name\":\"" << zone_names_[e.zone]
+          << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+          << ToUs(e.start - epoch_) << ",\"dur\":" << ToUs(e.duration) << '}';
+      first = false;
+    }
+  }
+  out << "\n]}\n";
+}
+
+std::uint32_t Profiler::FindZone(const char* name) {
+  for (std::size_t i = 0; i < zone_names_.size(); ++i) {
+    if (zone_names_[i] == name || std::strcmp(zone_names_[i], name) == 0)
+      return static_cast<std::uint32_t>(i);
+  }
+  zone_names_.push_back(name);
+  return static_cast<std::uint32_t>(zone_names_.size() - 1);
+}
+
+const Profiler::Frame& Profiler::GetFrame(std::size_t age) const {
+  if (age >= frame_count_)
+    throw std::out_of_range("Frame is not in the profiler history");
+  return frames_[(current_ + kFrameHistory - 1 - age) % kFrameHistory];
+}
+
+void DrawOverlay(int x, int y) {
+  // Without a font the overlay is a chart: one row per zone with the average
+  // as a bar and the p99 as a tick, then the frame history below. The red
+  // line marks a 60 Hz frame budget.
+  constexpr int kPixelsPerMs = 10;
+  constexpr int kRowHeight = 8;
+  constexpr int kGraphHeight = 60;
+  constexpr int kBudgetPixels = 1000 * kPixelsPerMs / 60;
+  constexpr SDL_Color kColors[] = {{80, 200, 120, 255},  {90, 160, 240, 255},
+                                   {240, 200, 80, 255},  {230, 110, 200, 255},
+                                   {120, 230, 230, 255}, {240, 140, 90, 255}};
+
+  const Profiler& profiler = Profiler::GetInstance();
+  const int zones = static_cast<int>(profiler.GetZoneCount());
+  const int frames = static_cast<int>(profiler.GetFrameCount());
+  const int width = std::max(2 * kBudgetPixels, frames);
+  const int height = zones * kRowHeight + kGraphHeight + 6;
+  SDL_Renderer* renderer = render::GetRenderer();
+
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+  SDL_RenderFillRect(renderer, render::MakeRect(x, y, width, height));
+
+  for (int zone = 0; zone < zones; ++zone) {
+    const ZoneStats stats = profiler.GetStats(zone);
+    const SDL_Color& c = kColors[zone % std::size(kColors)];
+    const int row = y + 2 + zone * kRowHeight;
+    SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+    SDL_RenderFillRect(renderer,
+                       render::MakeRect(x, row,
+                                        static_cast<int>(stats.avg_ms *
+                                                         kPixelsPerMs),
+                                        kRowHeight - 2));
+    SDL_RenderFillRect(renderer,
+                       render::MakeRect(x + static_cast<int>(stats.p99_ms *
+                                                             kPixelsPerMs),
+                                        row, 2, kRowHeight - 2));
+  }
+
+  // Zone 0 is the outermost zone, the whole frame when wired by GameApp.
+  const int graph_bottom = y + height - 2;
+  SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+  for (int age = 0; age < frames && zones > 0; ++age) {
+    const int bar = std::min(
+        kGraphHeight,
+        static_cast<int>(profiler.GetZoneMs(0, age) * kGraphHeight * 60 /
+                         1000 / 2));
+    SDL_RenderFillRect(renderer, render::MakeRect(x + width - 1 - age,
+                                                  graph_bottom - bar, 1, bar));
+  }
+
+  SDL_SetRenderDrawColor(renderer, 255, 60, 60, 255);
+  SDL_RenderFillRect(renderer, render::MakeRect(x + kBudgetPixels, y, 1,
+                                                zones * kRowHeight));
+  SDL_RenderFillRect(renderer, render::MakeRect(x, graph_bottom -
+                                                       kGraphHeight / 2,
+                                                width, 1));
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+}  // namespace profiler
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace profiler {
+
+using Clock = std::chrono::steady_clock;
+
+struct ZoneStats {
+  double min_ms = 0;
+  double avg_ms = 0;
+  double p99_ms = 0;
+};
+
+// Hot path timer of the main loop. Zones are recorded between BeginFrame()
+// and EndFrame() and the last kFrameHistory frames are kept in a ring buffer
+// for statistics, the overlay and the CSV / Chrome trace dumps.
+//
+// Zones must be entered from the main thread only. Zone names are compared
+// by pointer first, so pass string literals.
+class Profiler {
+ public:
+  static constexpr std::size_t kFrameHistory = 240;
+  static constexpr std::size_t kNoEvent = ~std::size_t{0};
+
+  static Profiler& GetInstance() {
+    static Profiler instance;
+    return instance;
+  }
+
+  void BeginFrame();
+  void EndFrame();
+
+  std::size_t BeginZone(const char* name);
+  void EndZone(std::size_t event);
+
+  std::size_t GetZoneCount() const;
+  const char* GetZoneName(std::size_t zone) const;
+  // Number of completed frames in the history.
+  std::size_t GetFrameCount() const;
+  // Time spent in |zone| |age| frames ago, 0 being the last completed frame.
+  double GetZoneMs(std::size_t zone, std::size_t age) const;
+  ZoneStats GetStats(std::size_t zone) const;
+
+  void WriteCsv(const std::filesystem::path& path) const;
+  void WriteChromeTrace(const std::filesystem::path& path) const;
+
+ private:
+  struct Event {
+    std::uint32_t zone = 0;
+    Clock::time_point start;
+    Clock::duration duration{};
+  };
+
+  struct Frame {
+    std::uint64_t index = 0;
+    std::vector<Event> events;
+    std::vector<Clock::duration> zone_totals;
+  };
+
+  Profiler() = default;
+
+  std::uint32_t FindZone(const char* name);
+  const Frame& GetFrame(std::size_t age) const;
+
+  std::vector<const char*> zone_names_;
+  std::array<Frame, kFrameHistory> frames_;
+  std::size_t current_ = 0;
+  std::size_t frame_count_ = 0;
+  std::uint64_t frame_index_ = 0;
+  bool in_frame_ = false;
+  Clock::time_point epoch_ = Clock::now();
+};
+
+// Times the enclosing scope as a zone of the current frame.
+class ScopedZone {
+ public:
+  explicit ScopedZone(const char* name)
+      : event_(Profiler::GetInstance().BeginZone(name)) {}
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+  ~ScopedZone() { Profiler::GetInstance().EndZone(event_); }
+
+ private:
+  std::size_t event_;
+};
+
+// Draws the zone statistics and a frame time graph at |x|, |y|. Call after
+// render::FlushSprites() so the overlay stays on top.
+void DrawOverlay(int x, int y);
+
+}  // namespace profiler
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+  ::profiler::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
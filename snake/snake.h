@@ -2,87 +2,126 @@
 
 #include "../graphics/graphics.h"
 
-#include <functional>
-#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 
-class Cell {
+enum class Tile : std::uint8_t {
+  kEmpty,
+  kApple,
+};
+
+// Tiles in one contiguous row-major array. The grid is drawn into a cached
+// texture, and a frame only redraws the tiles changed since the last one.
+// Empty tiles are transparent apart from their outline, so the background
+// shows through.
+class GameField {
  public:
-  virtual ~Cell() = default;
-  virtual void Render(int x, int y) = 0;
+  static constexpr int kTileSize = 32;
 
-  void OnVisit(std::function<void()> on_visit) { this->on_visit = on_visit; }
+  // |apple| is drawn on Tile::kApple tiles.
+  explicit GameField(render::TextureHandle apple, int w = 24, int h = 24)
+      : width_(w), height_(h), tiles_(w * h, Tile::kEmpty), apple_(apple) {}
 
-  void Visit() {
-    if (on_visit) {
-      on_visit();
-    }
+  GameField(const GameField&) = delete;
+  GameField& operator=(const GameField&) = delete;
+
+  ~GameField() {
+    if (cache_)
+      SDL_DestroyTexture(cache_);
   }
 
- private:
-  std::function<void()> on_visit;
-};
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
 
-class EmptyCell : public Cell {
- public:
-  void Render(int x, int y) override {
-    SDL_SetRenderDrawColor(render::GetRenderer(), 255, 255, 255, 255);
-    SDL_RenderDrawRect(render::GetRenderer(),
-                       render::MakeRect(x * 32, y * 32, 32, 32));
+  bool Contains(int x, int y) const {
+    return x >= 0 && x < width_ && y >= 0 && y < height_;
   }
-};
 
-class AppleCell : public Cell {
- public:
-  void Render(int x, int y) {
-    SDL_SetRenderDrawColor(render::GetRenderer(), 255, 255, 255, 255);
-    SDL_RenderDrawRect(render::GetRenderer(),
-                       render::MakeRect(x * 32, y * 32, 32, 32));
-
-    render::DrawImage("apple.png", x * 32, y * 32,  32, 32);
+  // Tile::kEmpty outside the field.
+  Tile GetTile(int x, int y) const {
+    return Contains(x, y) ? tiles_[y * width_ + x] : Tile::kEmpty;
   }
-};
 
-class GameField {
- public:
-  GameField(int w = 24, int h = 24) {
-    fields.resize(w);
-    for (auto& column : fields) {
-      column.resize(h);
-      for (auto& cell : column) {
-        cell = std::make_unique<EmptyCell>();
-      }
-    }
+  void SetTile(int x, int y, Tile tile) {
+    const int index = y * width_ + x;
+    if (tiles_[index] == tile)
+      return;
+    tiles_[index] = tile;
+    dirty_.push_back(index);
   }
 
-  int GetWidth() const { return fields.size(); }
-  int GetHeight() const { return fields[0].size(); }
+  // Redraws every tile on the next Render(). Needed after
+  // SDL_RENDER_TARGETS_RESET, which loses the content of the cache.
+  void Invalidate() { redraw_all_ = true; }
 
+  // Draws immediately, after flushing the sprites queued so far, so the
+  // field covers the background and immediate drawing such as
+  // Snake::Render() goes on top of it.
   void Render() {
-    // Render background
-    for (int x = 0; x < GetWidth(); ++x) {
-      for (int y = 0; y < GetHeight(); ++y) {
-        fields[x][y]->Render(x, y);
+    SDL_Renderer* renderer = render::GetRenderer();
+    if (!cache_) {
+      cache_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                 SDL_TEXTUREACCESS_TARGET, width_ * kTileSize,
+                                 height_ * kTileSize);
+      if (!cache_)
+        throw std::runtime_error(std::string("Can't create field cache: ") +
+                                 SDL_GetError());
+      SDL_SetTextureBlendMode(cache_, SDL_BLENDMODE_BLEND);
+      redraw_all_ = true;
+    }
+
+    if (redraw_all_ || !dirty_.empty()) {
+      SDL_Texture* target = SDL_GetRenderTarget(renderer);
+      SDL_SetRenderTarget(renderer, cache_);
+      // Clearing a tile must overwrite its pixels, not blend over them.
+      SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+      if (redraw_all_) {
+        for (int index = 0; index < width_ * height_; ++index) {
+          RenderTile(index);
+        }
+      } else {
+        for (int index : dirty_) {
+          RenderTile(index);
+        }
       }
+      SDL_SetRenderTarget(renderer, target);
+      dirty_.clear();
+      redraw_all_ = false;
     }
-  }
 
-  Cell* GetCell(int x, int y) const {
-    if (x < 0 || x >= fields.size())
-      return nullptr;
-    if (y < 0 || y >= fields[x].size())
-      return nullptr;
-    return fields[x][y].get();
+    render::FlushSprites();
+    const SDL_Rect dest = {0, 0, width_ * kTileSize, height_ * kTileSize};
+    SDL_RenderCopy(renderer, cache_, nullptr, &dest);
   }
 
-  Cell* SetCell(int x, int y, Cell* cell) {
-    fields[x][y].reset(cell);
-    return fields[x][y].get();
+ private:
+  void RenderTile(int index) {
+    SDL_Renderer* renderer = render::GetRenderer();
+    const SDL_Rect rect = {index % width_ * kTileSize,
+                           index / width_ * kTileSize, kTileSize, kTileSize};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderFillRect(renderer, &rect);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &rect);
+
+    if (tiles_[index] == Tile::kApple) {
+      // The apple may be packed on a shared atlas page.
+      const SDL_Rect source = render::GetTextureRect(apple_);
+      SDL_RenderCopy(renderer, render::GetTexture(apple_), &source, &rect);
+    }
   }
 
- private:
-  std::vector<std::vector<std::unique_ptr<Cell>>> fields;
+  int width_;
+  int height_;
+  std::vector<Tile> tiles_;
+  // Tiles changed since the last Render(), may repeat.
+  std::vector<int> dirty_;
+  bool redraw_all_ = true;
+  SDL_Texture* cache_ = nullptr;
+  render::TextureHandle apple_;
 };
 
 struct Coords {
@@ -101,39 +140,76 @@ enum Direction {
   RIGHT,
 };
 
+// The body is a ring buffer sized for a snake filling the whole field, and
+// an occupancy bitmap over the field answers collision tests, so moving,
+// growing and colliding cost O(1) whatever the length.
 class Snake {
  public:
-  explicit Snake(const Coords& head) {
-    direction = NONE;
-    units.push_back(head);
+  enum class MoveResult {
+    kIdle,
+    kMoved,
+    // The snake stays in place on collisions.
+    kHitWall,
+    kHitSelf,
+  };
+
+  Snake(const Coords& head, const GameField& field)
+      : width_(field.GetWidth()),
+        height_(field.GetHeight()),
+        units_(width_ * height_),
+        occupied_((width_ * height_ + 63) / 64) {
+    if (!field.Contains(head.x, head.y))
+      throw std::invalid_argument("Snake head outside the field");
+    units_[0] = head;
+    length_ = 1;
+    SetOccupied(head, true);
   }
 
-  const std::vector<Coords>& GetUnits() const { return units; }
+  // Unit 0 is the head.
+  int GetLength() const { return length_; }
+  const Coords& GetUnit(int i) const {
+    return units_[(head_ + i) % units_.size()];
+  }
 
-  void SetHead(const Coords& head) { units[0] = head; }
-  const Coords& GetHead() const { return units[0]; }
+  // True if a unit of the snake is on |c|.
+  bool Occupies(const Coords& c) const {
+    if (!Contains(c))
+      return false;
+    const int index = c.y * width_ + c.x;
+    return occupied_[index / 64] >> (index % 64) & 1;
+  }
+
+  // Throws std::invalid_argument if |head| is outside the field.
+  void SetHead(const Coords& head) {
+    if (!Contains(head))
+      throw std::invalid_argument("Snake head outside the field");
+    SetOccupied(GetHead(), false);
+    units_[head_] = head;
+    SetOccupied(head, true);
+  }
+  const Coords& GetHead() const { return units_[head_]; }
 
   void SetDirection(Direction dir) {
-    if (direction != NONE && dir == NONE)
+    if (direction_ != NONE && dir == NONE)
       return;
-    if (direction == UP && dir == DOWN)
+    if (direction_ == UP && dir == DOWN)
       return;
-    if (direction == DOWN && dir == UP)
+    if (direction_ == DOWN && dir == UP)
       return;
-    if (direction == LEFT && dir == RIGHT)
+    if (direction_ == LEFT && dir == RIGHT)
       return;
-    if (direction == RIGHT && dir == LEFT)
+    if (direction_ == RIGHT && dir == LEFT)
       return;
-    direction = dir;
+    direction_ = dir;
   }
 
-  void Grow(int count) { grow += count; }
+  void Grow(int count) { grow_ += count; }
 
-  void UpdateState() {
-    Coords new_head = units[0];
-    switch (direction) {
+  MoveResult UpdateState() {
+    Coords new_head = GetHead();
+    switch (direction_) {
       case NONE:
-        return;
+        return MoveResult::kIdle;
       case UP:
         new_head.y--;
         break;
@@ -147,25 +223,60 @@ class Snake {
         new_head.x--;
         break;
     }
-    units.insert(units.begin(), new_head);
-    if (grow > 0) {
-      --grow;
-      return;
-    }
+    if (!Contains(new_head))
+      return MoveResult::kHitWall;
+
+    // Without growth the tail moves away this tick, so the head may take
+    // its place.
+    const bool growing = grow_ > 0;
+    const Coords& tail = GetUnit(length_ - 1);
+    if (Occupies(new_head) && (growing || !(new_head == tail)))
+      return MoveResult::kHitSelf;
 
-    units.pop_back();
+    if (growing) {
+      --grow_;
+      ++length_;
+    } else {
+      SetOccupied(tail, false);
+    }
+    head_ = (head_ + units_.size() - 1) % units_.size();
+    units_[head_] = new_head;
+    SetOccupied(new_head, true);
+    return MoveResult::kMoved;
   }
 
   void Render() {
-    for (const Coords& u : units) {
-      SDL_SetRenderDrawColor(render::GetRenderer(), 255, 191, 0, 0);
+    SDL_SetRenderDrawColor(render::GetRenderer(), 255, 191, 0, 0);
+    for (int i = 0; i < length_; ++i) {
+      const Coords& u = GetUnit(i);
       SDL_RenderFillRect(render::GetRenderer(),
                          render::MakeRect(u.x * 32 + 3, u.y * 32 + 3, 26, 26));
     }
   }
 
  private:
-  Direction direction;
-  std::vector<Coords> units;
-  int grow = 0;
+  bool Contains(const Coords& c) const {
+    return c.x >= 0 && c.x < width_ && c.y >= 0 && c.y < height_;
+  }
+
+  void SetOccupied(const Coords& c, bool occupied) {
+    const int index = c.y * width_ + c.x;
+    const std::uint64_t bit = std::uint64_t{1} << (index % 64);
+    if (occupied) {
+      occupied_[index / 64] |= bit;
+    } else {
+      occupied_[index / 64] &= ~bit;
+    }
+  }
+
+  int width_;
+  int height_;
+  Direction direction_ = NONE;
+  // Ring buffer of units, the head at |head_|.
+  std::vector<Coords> units_;
+  std::size_t head_ = 0;
+  int length_ = 0;
+  int grow_ = 0;
+  // One bit per field tile, row-major.
+  std::vector<std::uint64_t> occupied_;
 };
@@ -0,0 +1,218 @@
+// Builds an asset pack (see graphics/asset_pack.h) from image files:
+//
+//   asset_packer <output> <image>...
+//
+// Every image is registered under its file name, like render::LoadResource()
+// names it. Images fitting in a quarter page share packed pages, larger ones
+// get a page of their own.
+
+#include "../graphics/asset_pack.h"
+#include "../graphics/rect_packer.h"
+
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kPageSize = 1024;
+constexpr int kPadding = 1;
+
+struct Image {
+  std::string name;
+  int width = 0;
+  int height = 0;
+  std::vector<std::uint8_t> pixels;
+  std::size_t page = 0;
+  render::RectPacker::Position position;
+};
+
+struct Page {
+  int width = 0;
+  int height = 0;
+  std::vector<std::uint8_t> pixels;
+};
+
+Image Decode(const std::filesystem::path& path) {
+  SDL_Surface* loaded = IMG_Load(path.string().c_str());
+  if (!loaded)
+    throw std::invalid_argument("Can't load " + path.string() + ": " +
+                                IMG_GetError());
+  SDL_Surface* surface =
+      SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(loaded);
+  if (!surface)
+    throw std::runtime_error("Can't convert " + path.string());
+
+  Image image;
+  image.name = path.filename().string();
+  image.width = surface->w;
+  image.height = surface->h;
+  image.pixels.resize(std::size_t(surface->w) * surface->h * 4);
+  SDL_LockSurface(surface);
+  for (int y = 0; y < surface->h; ++y) {
+    std::memcpy(image.pixels.data() + std::size_t(y) * surface->w * 4,
+                static_cast<const std::uint8_t*>(surface->pixels) +
+                    std::size_t(y) * surface->pitch,
+                std::size_t(surface->w) * 4);
+  }
+  SDL_UnlockSurface(surface);
+  SDL_FreeSurface(surface);
+  return image;
+}
+
+void Blit(const Image& image, Page& page) {
+  for (int y = 0; y < image.height; ++y) {
+    std::memcpy(page.pixels.data() +
+                    (std::size_t(image.position.y + y) * page.width +
+                     image.position.x) *
+                        4,
+                image.pixels.data() + std::size_t(y) * image.width * 4,
+                std::size_t(image.width) * 4);
+  }
+}
+
+std::vector<Page> Pack(std::vector<Image>& images) {
+  std::vector<Image*> order;
+  for (auto& image : images) {
+    order.push_back(&image);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const Image* lhs, const Image* rhs) {
+                     return lhs->height > rhs->height;
+                   });
+
+  std::vector<Page> pages;
+  std::vector<std::optional<render::RectPacker>> packers;
+  for (Image* image : order) {
+    const int w = image->width + kPadding;
+    const int h = image->height + kPadding;
+    std::optional<render::RectPacker::Position> position;
+    if (w <= kPageSize / 2 && h <= kPageSize / 2) {
+      for (image->page = 0; image->page < packers.size(); ++image->page) {
+        if (packers[image->page] &&
+            (position = packers[image->page]->Insert(w, h)))
+          break;
+      }
+      if (!position) {
+        packers.emplace_back(render::RectPacker(kPageSize, kPageSize));
+        pages.push_back({kPageSize, kPageSize, {}});
+        position = packers.back()->Insert(w, h);
+      }
+    } else {
+      image->page = pages.size();
+      packers.emplace_back();
+      pages.push_back({image->width, image->height, {}});
+      position = render::RectPacker::Position{};
+    }
+    image->position = *position;
+  }
+
+  for (auto& page : pages) {
+    page.pixels.assign(std::size_t(page.width) * page.height * 4, 0);
+  }
+  for (const auto& image : images) {
+    Blit(image, pages[image.page]);
+  }
+  return pages;
+}
+
+template <typename T>
+void Write(std::ofstream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WritePack(const std::filesystem::path& path,
+               const std::vector<Image>& images,
+               const std::vector<Page>& pages) {
+  namespace ap = render::asset_pack;
+
+  std::uint64_t names_size = 0;
+  for (const auto& image : images) {
+    names_size += image.name.size();
+  }
+  const std::uint64_t pixels_begin =
+      sizeof(ap::Header) + pages.size() * sizeof(ap::Page) +
+      images.size() * sizeof(ap::Entry) + names_size;
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    throw std::invalid_argument("Can't write " + path.string());
+
+  ap::Header header;
+  std::memcpy(header.magic, ap::kMagic, sizeof(header.magic));
+  header.version = ap::kVersion;
+  header.page_count = static_cast<std::uint32_t>(pages.size());
+  header.entry_count = static_cast<std::uint32_t>(images.size());
+  Write(out, header);
+
+  std::vector<std::uint64_t> offsets;
+  std::uint64_t offset = pixels_begin;
+  for (const auto& page : pages) {
+    offset = (offset + ap::kAlignment - 1) / ap::kAlignment * ap::kAlignment;
+    offsets.push_back(offset);
+    Write(out, ap::Page{static_cast<std::uint32_t>(page.width),
+                        static_cast<std::uint32_t>(page.height), offset});
+    offset += page.pixels.size();
+  }
+
+  std::uint32_t name_offset = 0;
+  for (const auto& image : images) {
+    Write(out, ap::Entry{static_cast<std::uint32_t>(image.page),
+                         image.position.x, image.position.y, image.width,
+                         image.height, name_offset,
+                         static_cast<std::uint32_t>(image.name.size())});
+    name_offset += static_cast<std::uint32_t>(image.name.size());
+  }
+  for (const auto& image : images) {
+    out.write(image.name.data(), image.name.size());
+  }
+
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    const std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+    for (std::uint64_t p = position; p < offsets[i]; ++p) {
+      out.put(0);
+    }
+    out.write(reinterpret_cast<const char*>(pages[i].pixels.data()),
+              pages[i].pixels.size());
+  }
+
+  if (!out)
+    throw std::runtime_error("Failed writing " + path.string());
+}
+
+}  // namespace
+
+#undef main
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: asset_packer <output> <image>..." << std::endl;
+    return 1;
+  }
+
+  try {
+    std::vector<Image> images;
+    for (int i = 2; i < argc; ++i) {
+      images.push_back(Decode(argv[i]));
+    }
+    const auto pages = Pack(images);
+    WritePack(argv[1], images, pages);
+    std::cout << "Packed " << images.size() << " images into " << pages.size()
+              << " pages: " << argv[1] << std::endl;
+  } catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ztyp.h"
+
+namespace zt {
+
+// Axis-aligned rectangle [min, max] in world coordinates.
+struct Bounds {
+  bool Contains(const Vector2d& p) const {
+    return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y;
+  }
+
+  Bounds Expanded(float margin) const {
+    return {{min.x - margin, min.y - margin}, {max.x + margin, max.y + margin}};
+  }
+
+  Vector2d min;
+  Vector2d max;
+};
+
+}  // namespace zt
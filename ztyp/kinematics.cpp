@@ -0,0 +1,170 @@
+#include "kinematics.h"
+
+#include <SDL_cpuinfo.h>
+
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ZT_KINEMATICS_X86 1
+#include <immintrin.h>
+#else
+#define ZT_KINEMATICS_X86 0
+#endif
+
+// GCC and Clang only emit AVX instructions in functions built for that
+// target; MSVC accepts the intrinsics anywhere.
+#if ZT_KINEMATICS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ZT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ZT_TARGET_AVX2
+#endif
+
+namespace zt {
+
+namespace internal {
+
+bool IsKinematicsBackendSupported(KinematicsBackend backend) {
+  switch (backend) {
+    case KinematicsBackend::kScalar:
+      return true;
+    case KinematicsBackend::kSse2:
+      return ZT_KINEMATICS_X86 && SDL_HasSSE2();
+    case KinematicsBackend::kAvx2:
+      return ZT_KINEMATICS_X86 && SDL_HasAVX2();
+  }
+  return false;
+}
+
+void IntegrateScalar(float* x,
+                     float* y,
+                     const float* vx,
+                     const float* vy,
+                     std::size_t count,
+                     float dt) {
+  for (std::size_t i = 0; i < count; ++i) {
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+  }
+}
+
+#if ZT_KINEMATICS_X86
+
+void IntegrateSse2(float* x,
+                   float* y,
+                   const float* vx,
+                   const float* vy,
+                   std::size_t count,
+                   float dt) {
+  const __m128 step = _mm_set1_ps(dt);
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i),
+                                    _mm_mul_ps(_mm_loadu_ps(vx + i), step)));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i),
+                                    _mm_mul_ps(_mm_loadu_ps(vy + i), step)));
+  }
+  IntegrateScalar(x + i, y + i, vx + i, vy + i, count - i, dt);
+}
+
+ZT_TARGET_AVX2 void IntegrateAvx2(float* x,
+                                  float* y,
+                                  const float* vx,
+                                  const float* vy,
+                                  std::size_t count,
+                                  float dt) {
+  const __m256 step = _mm256_set1_ps(dt);
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(
+        x + i, _mm256_add_ps(_mm256_loadu_ps(x + i),
+                             _mm256_mul_ps(_mm256_loadu_ps(vx + i), step)));
+    _mm256_storeu_ps(
+        y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                             _mm256_mul_ps(_mm256_loadu_ps(vy + i), step)));
+  }
+  IntegrateScalar(x + i, y + i, vx + i, vy + i, count - i, dt);
+}
+
+#else
+
+void IntegrateSse2(float* x,
+                   float* y,
+                   const float* vx,
+                   const float* vy,
+                   std::size_t count,
+                   float dt) {
+  IntegrateScalar(x, y, vx, vy, count, dt);
+}
+
+void IntegrateAvx2(float* x,
+                   float* y,
+                   const float* vx,
+                   const float* vy,
+                   std::size_t count,
+                   float dt) {
+  IntegrateScalar(x, y, vx, vy, count, dt);
+}
+
+#endif
+
+}  // namespace internal
+
+namespace {
+
+using IntegrateFunction = void (*)(float*,
+                                   float*,
+                                   const float*,
+                                   const float*,
+                                   std::size_t,
+                                   float);
+
+IntegrateFunction GetIntegrateFunction(KinematicsBackend backend) {
+  switch (backend) {
+    case KinematicsBackend::kAvx2:
+      return internal::IntegrateAvx2;
+    case KinematicsBackend::kSse2:
+      return internal::IntegrateSse2;
+    case KinematicsBackend::kScalar:
+      break;
+  }
+  return internal::IntegrateScalar;
+}
+
+}  // namespace
+
+KinematicsBackend GetKinematicsBackend() {
+  static const KinematicsBackend backend = [] {
+    for (auto backend :
+         {KinematicsBackend::kAvx2, KinematicsBackend::kSse2}) {
+      if (internal::IsKinematicsBackendSupported(backend))
+        return backend;
+    }
+    return KinematicsBackend::kScalar;
+  }();
+  return backend;
+}
+
+const char* GetKinematicsBackendName(KinematicsBackend backend) {
+  switch (backend) {
+    case KinematicsBackend::kScalar:
+      return "scalar";
+    case KinematicsBackend::kSse2:
+      return "sse2";
+    case KinematicsBackend::kAvx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+void IntegratePositions(float* x,
+                        float* y,
+                        const float* vx,
+                        const float* vy,
+                        std::size_t count,
+                        float dt) {
+  static const IntegrateFunction integrate =
+      GetIntegrateFunction(GetKinematicsBackend());
+  integrate(x, y, vx, vy, count, dt);
+}
+
+}  // namespace zt
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+namespace zt {
+
+enum class KinematicsBackend {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+// Advances |count| positions by their velocities: x += vx * dt,
+// y += vy * dt. The widest kernel supported by the CPU is picked on the
+// first call.
+void IntegratePositions(float* x,
+                        float* y,
+                        const float* vx,
+                        const float* vy,
+                        std::size_t count,
+                        float dt);
+
+KinematicsBackend GetKinematicsBackend();
+const char* GetKinematicsBackendName(KinematicsBackend backend);
+
+namespace internal {
+
+// Individual kernels, exposed for benchmarks. Only call the SIMD ones when
+// IsKinematicsBackendSupported() returns true.
+bool IsKinematicsBackendSupported(KinematicsBackend backend);
+
+void IntegrateScalar(float* x,
+                     float* y,
+                     const float* vx,
+                     const float* vy,
+                     std::size_t count,
+                     float dt);
+void IntegrateSse2(float* x,
+                   float* y,
+                   const float* vx,
+                   const float* vy,
+                   std::size_t count,
+                   float dt);
+void IntegrateAvx2(float* x,
+                   float* y,
+                   const float* vx,
+                   const float* vy,
+                   std::size_t count,
+                   float dt);
+
+}  // namespace internal
+
+}  // namespace zt
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zt {
+
+// Reference to an object in a Pool. A handle whose object was destroyed
+// becomes stale: the slot may be reused, but its generation no longer matches
+// and Pool::Get() returns nullptr for it.
+template <typename T>
+struct Handle {
+  static constexpr std::uint32_t kInvalidIndex = ~std::uint32_t{0};
+
+  bool IsValid() const { return index != kInvalidIndex; }
+
+  bool operator==(const Handle& o) const {
+    return index == o.index && generation == o.generation;
+  }
+  bool operator!=(const Handle& o) const { return !(*this == o); }
+
+  std::uint32_t index = kInvalidIndex;
+  std::uint32_t generation = 0;
+};
+
+// Fixed type object pool. Objects live in chunks that are never moved, so
+// pointers stay valid until the object is destroyed, and destroyed slots are
+// recycled through a free list before the pool grows.
+template <typename T>
+class Pool {
+ public:
+  Pool() = default;
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  ~Pool() { Clear(); }
+
+  template <typename... Args>
+  Handle<T> Create(Args&&... args) {
+    if (free_ == kNone)
+      Grow();
+
+    const std::uint32_t index = free_;
+    Slot& slot = GetSlot(index);
+    new (slot.storage) T(std::forward<Args>(args)...);
+    free_ = slot.next_free;
+    slot.alive = true;
+    ++size_;
+    return {index, slot.generation};
+  }
+
+  // Returns false for stale handles.
+  bool Destroy(Handle<T> handle) {
+    if (!Get(handle))
+      return false;
+
+    Slot& slot = GetSlot(handle.index);
+    slot.Object()->~T();
+    slot.alive = false;
+    ++slot.generation;
+    slot.next_free = free_;
+    free_ = handle.index;
+    --size_;
+    return true;
+  }
+
+  T* Get(Handle<T> handle) {
+    if (handle.index >= capacity_)
+      return nullptr;
+    Slot& slot = GetSlot(handle.index);
+    if (!slot.alive || slot.generation != handle.generation)
+      return nullptr;
+    return slot.Object();
+  }
+
+  const T* Get(Handle<T> handle) const {
+    return const_cast<Pool*>(this)->Get(handle);
+  }
+
+  // Calls |f(handle, object)| for every live object. |f| may destroy the
+  // visited object but must not create new ones.
+  template <typename F>
+  void ForEach(F&& f) {
+    for (std::uint32_t i = 0; i < capacity_; ++i) {
+      Slot& slot = GetSlot(i);
+      if (slot.alive)
+        f(Handle<T>{i, slot.generation}, *slot.Object());
+    }
+  }
+
+  template <typename F>
+  void ForEach(F&& f) const {
+    const_cast<Pool*>(this)->ForEach(
+        [&](Handle<T> handle, const T& object) { f(handle, object); });
+  }
+
+  void Clear() {
+    ForEach([this](Handle<T> handle, T&) { Destroy(handle); });
+  }
+
+  std::size_t Size() const { return size_; }
+  std::size_t Capacity() const { return capacity_; }
+
+ private:
+  static constexpr std::uint32_t kChunkSize = 256;
+  static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+
+  struct Slot {
+    T* Object() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+    alignas(T) unsigned char storage[sizeof(T)];
+    std::uint32_t generation = 0;
+    std::uint32_t next_free = kNone;
+    bool alive = false;
+  };
+
+  Slot& GetSlot(std::uint32_t index) {
+    return chunks_[index / kChunkSize][index % kChunkSize];
+  }
+
+  void Grow() {
+    chunks_.push_back(std::make_unique<Slot[]>(kChunkSize));
+    const std::uint32_t first = capacity_;
+    capacity_ += kChunkSize;
+    for (std::uint32_t i = capacity_; i-- > first;) {
+      GetSlot(i).next_free = free_;
+      free_ = i;
+    }
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> chunks_;
+  std::uint32_t capacity_ = 0;
+  std::uint32_t free_ = kNone;
+  std::size_t size_ = 0;
+};
+
+// Bump allocator for objects that only live until the next Reset(), e.g. for
+// the duration of one tick. Blocks are kept across resets, so a steady frame
+// doesn't allocate.
+class FrameArena {
+ public:
+  explicit FrameArena(std::size_t block_size = 64 * 1024)
+      : block_size_(block_size) {}
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  ~FrameArena() { Reset(); }
+
+  void* Allocate(std::size_t size, std::size_t alignment) {
+    for (; block_ < blocks_.size(); ++block_, offset_ = 0) {
+      Block& block = blocks_[block_];
+      const std::size_t begin = (offset_ + alignment - 1) & ~(alignment - 1);
+      if (begin + size <= block.size) {
+        offset_ = begin + size;
+        return block.data.get() + begin;
+      }
+    }
+
+    const std::size_t block_size = std::max(block_size_, size + alignment);
+    blocks_.push_back({std::make_unique<unsigned char[]>(block_size),
+                       block_size});
+    offset_ = 0;
+    return Allocate(size, alignment);
+  }
+
+  template <typename T, typename... Args>
+  T* Create(Args&&... args) {
+    T* object = new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.push_back(
+          {[](void* p) { static_cast<T*>(p)->~T(); }, object});
+    }
+    return object;
+  }
+
+  // Destroys every object created since the last reset.
+  void Reset() {
+    for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+      it->destroy(it->object);
+    }
+    destructors_.clear();
+    block_ = 0;
+    offset_ = 0;
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<unsigned char[]> data;
+    std::size_t size = 0;
+  };
+
+  struct Destructor {
+    void (*destroy)(void*);
+    void* object;
+  };
+
+  std::size_t block_size_;
+  std::vector<Block> blocks_;
+  std::vector<Destructor> destructors_;
+  std::size_t block_ = 0;
+  std::size_t offset_ = 0;
+};
+
+}  // namespace zt
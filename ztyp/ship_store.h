@@ -0,0 +1,344 @@
+#pragma once
+
+#include "../jobs/job_system.h"
+#include "bounds.h"
+#include "kinematics.h"
+#include "pool.h"
+#include "spatial_grid.h"
+#include "ztyp.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+namespace zt {
+
+// Ships of one type in structure-of-arrays layout, so that an update kernel
+// is a linear sweep over packed floats.
+struct ShipArray {
+  std::size_t Size() const { return x.size(); }
+
+  void Push(const Vector2d& p, const Vector2d& v, int max_hp) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+    prev_x.push_back(p.x);
+    prev_y.push_back(p.y);
+    vx.push_back(v.x);
+    vy.push_back(v.y);
+    timer.push_back(0);
+    hp.push_back(max_hp);
+  }
+
+  void Reserve(std::size_t count) {
+    for (auto* v : {&x, &y, &prev_x, &prev_y, &vx, &vy, &timer}) {
+      v->reserve(count);
+    }
+    hp.reserve(count);
+  }
+
+  // Moves the last ship into slot |i|, so the order of ships changes.
+  void SwapRemove(std::size_t i) {
+    for (auto* v : {&x, &y, &prev_x, &prev_y, &vx, &vy, &timer}) {
+      (*v)[i] = v->back();
+      v->pop_back();
+    }
+    hp[i] = hp.back();
+    hp.pop_back();
+  }
+
+  Vector2d GetPosition(std::size_t i) const { return {x[i], y[i]}; }
+
+  // Position between the previous and the current tick, see
+  // app::GameApp::Render().
+  Vector2d GetPosition(std::size_t i, float alpha) const {
+    return {prev_x[i] + (x[i] - prev_x[i]) * alpha,
+            prev_y[i] + (y[i] - prev_y[i]) * alpha};
+  }
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> prev_x;
+  std::vector<float> prev_y;
+  std::vector<float> vx;
+  std::vector<float> vy;
+  std::vector<float> timer;
+  std::vector<int> hp;
+};
+
+// Packed storage of all ships, grouped by type. Each type is advanced by its
+// own kernel instead of a virtual SpaceShip::Update() per ship.
+//
+// Rockets live in a Pool, so firing and removing them recycles slots instead
+// of allocating. Rockets and EMPs hit ships found through a SpatialGrid
+// rebuilt each tick.
+class ShipStore {
+ public:
+  ShipStore() = default;
+  ShipStore(const ShipStore&) = delete;
+  ShipStore& operator=(const ShipStore&) = delete;
+
+  // Same hp as the matching SpaceShip class.
+  static int GetMaxHp(ShipType type) {
+    return type == ShipType::kMother ? 10 : 1;
+  }
+
+  void Add(ShipType type, const Vector2d& p, const Vector2d& v) {
+    Get(type).Push(p, v, GetMaxHp(type));
+  }
+
+  void Add(const SpawnQueue& spawns) {
+    for (const SpawnCommand& spawn : spawns) {
+      Add(spawn.type, spawn.position, spawn.velocity);
+    }
+  }
+
+  // Ticks don't allocate while every type stays within |count| ships.
+  void Reserve(std::size_t count) {
+    for (auto& ships : ships_) {
+      ships.Reserve(count);
+    }
+    const std::size_t chunks = jobs::JobSystem::GetChunkCount(count, kGrain);
+    if (chunk_spawns_.size() < chunks)
+      chunk_spawns_.resize(chunks);
+  }
+
+  ShipArray& Get(ShipType type) {
+    return ships_[static_cast<std::size_t>(type)];
+  }
+
+  const ShipArray& Get(ShipType type) const {
+    return ships_[static_cast<std::size_t>(type)];
+  }
+
+  std::size_t Size() const {
+    std::size_t size = 0;
+    for (const auto& ships : ships_) {
+      size += ships.Size();
+    }
+    return size;
+  }
+
+  Handle<Rocket> LaunchRocket(const Vector2d& p, const Vector2d& v) {
+    return rockets_.Create(p, v);
+  }
+
+  // Returns nullptr once the rocket is gone.
+  const Rocket* GetRocket(Handle<Rocket> rocket) const {
+    return rockets_.Get(rocket);
+  }
+
+  // Calls |f(Handle<Rocket>, const Rocket&)| for every rocket in flight.
+  template <typename F>
+  void ForEachRocket(F&& f) const {
+    rockets_.ForEach(f);
+  }
+
+  std::size_t GetRocketCount() const { return rockets_.Size(); }
+
+  // Destroys every rocket for which |pred(rocket)| holds and returns their
+  // number.
+  template <typename Pred>
+  std::size_t RemoveRocketsIf(Pred&& pred) {
+    std::size_t removed = 0;
+    rockets_.ForEach([&](Handle<Rocket> handle, Rocket& rocket) {
+      if (pred(static_cast<const Rocket&>(rocket))) {
+        rockets_.Destroy(handle);
+        ++removed;
+      }
+    });
+    return removed;
+  }
+
+  // The EMP damages every ship within |radius| of |p| on the next Update().
+  void DetonateEmp(const Vector2d& p, float radius) {
+    emps_.push_back(arena_.Create<Emp>(p, radius));
+  }
+
+  // Ships and rockets outside |bounds| are removed at the end of every
+  // Update(), so that objects flying away stop costing update and draw time.
+  void SetDespawnBounds(const Bounds& bounds) { despawn_bounds_ = bounds; }
+
+  // Returns the number of removed ships and rockets.
+  std::size_t RemoveOutside(const Bounds& bounds) {
+    return RemoveShipsIf([&](const ShipArray& ships, std::size_t i) {
+             return !bounds.Contains(ships.GetPosition(i));
+           }) +
+           RemoveRocketsIf([&](const Rocket& rocket) {
+             return !bounds.Contains(rocket.GetPosition());
+           });
+  }
+
+  // With |jobs| the ships are updated in parallel chunks. Spawns are merged
+  // in chunk order, so the result is identical to the serial update.
+  void Update(float dt, jobs::JobSystem* jobs = nullptr) {
+    for (std::size_t type = 0; type < kShipTypeCount; ++type) {
+      const std::size_t count = ships_[type].Size();
+      const std::size_t chunks = jobs::JobSystem::GetChunkCount(count, kGrain);
+      if (chunk_spawns_.size() < chunks)
+        chunk_spawns_.resize(chunks);
+
+      auto kernel = [this, type, dt](std::size_t chunk, std::size_t begin,
+                                     std::size_t end) {
+        UpdateRange(static_cast<ShipType>(type), begin, end, dt,
+                    chunk_spawns_[chunk]);
+      };
+      if (jobs) {
+        jobs->ParallelFor(count, kGrain, kernel);
+      } else {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+          kernel(chunk, chunk * kGrain, std::min(count, (chunk + 1) * kGrain));
+        }
+      }
+    }
+
+    for (SpawnQueue& spawns : chunk_spawns_) {
+      Add(spawns);
+      spawns.Clear();
+    }
+
+    rockets_.ForEach([dt](Handle<Rocket>, Rocket& r) { r.Update(dt); });
+    ResolveCollisions();
+
+    if (despawn_bounds_)
+      RemoveOutside(*despawn_bounds_);
+  }
+
+ private:
+  static constexpr float kSpamPeriod = 10;
+  static constexpr float kRocketHitRadius = 24;
+  // Grid ids hold the ship type above the index within its ShipArray.
+  static constexpr std::uint32_t kIndexBits = 28;
+  static constexpr std::uint32_t kIndexMask = (1u << kIndexBits) - 1;
+  static constexpr std::size_t kGrain = 2048;
+
+  // Applies rocket and EMP damage and removes destroyed ships. A rocket is
+  // spent on the first ship it hits.
+  void ResolveCollisions() {
+    if (rockets_.Size() > 0 || !emps_.empty()) {
+      grid_.Clear();
+      for (std::size_t type = 0; type < kShipTypeCount; ++type) {
+        const ShipArray& ships = ships_[type];
+        for (std::size_t i = 0; i < ships.Size(); ++i) {
+          grid_.Insert(static_cast<std::uint32_t>(type << kIndexBits | i),
+                       ships.GetPosition(i));
+        }
+      }
+      grid_.Build();
+
+      rockets_.ForEach([this](Handle<Rocket> handle, Rocket& rocket) {
+        bool hit = false;
+        grid_.QueryRadius(rocket.GetPosition(), kRocketHitRadius,
+                          [&](std::uint32_t id) {
+                            if (!hit) {
+                              Damage(id, rocket.GetDamage());
+                              hit = true;
+                            }
+                          });
+        if (hit)
+          rockets_.Destroy(handle);
+      });
+      for (const Emp* emp : emps_) {
+        grid_.QueryRadius(emp->GetPosition(), emp->GetRadius(),
+                          [&](std::uint32_t id) {
+                            Damage(id, emp->GetDamage());
+                          });
+      }
+
+      RemoveShipsIf([](const ShipArray& ships, std::size_t i) {
+        return ships.hp[i] <= 0;
+      });
+    }
+
+    emps_.clear();
+    arena_.Reset();
+  }
+
+  void Damage(std::uint32_t id, int damage) {
+    ships_[id >> kIndexBits].hp[id & kIndexMask] -= damage;
+  }
+
+  // Swap-removes every ship for which |pred(ships, i)| holds.
+  template <typename Pred>
+  std::size_t RemoveShipsIf(Pred&& pred) {
+    std::size_t removed = 0;
+    for (auto& ships : ships_) {
+      for (std::size_t i = 0; i < ships.Size();) {
+        if (pred(ships, i)) {
+          ships.SwapRemove(i);
+          ++removed;
+        } else {
+          ++i;
+        }
+      }
+    }
+    return removed;
+  }
+
+  void UpdateRange(ShipType type,
+                   std::size_t begin,
+                   std::size_t end,
+                   float dt,
+                   SpawnQueue& spawns) {
+    ShipArray& ships = Get(type);
+    std::copy(ships.x.begin() + begin, ships.x.begin() + end,
+              ships.prev_x.begin() + begin);
+    std::copy(ships.y.begin() + begin, ships.y.begin() + end,
+              ships.prev_y.begin() + begin);
+
+    switch (type) {
+      case ShipType::kSmall:
+        Integrate(ships, begin, end, dt);
+        break;
+      case ShipType::kSpam:
+        Integrate(ships, begin, end, dt);
+        UpdateSpamTimers(ships, begin, end, dt, spawns);
+        break;
+      case ShipType::kMother:
+        break;
+    }
+  }
+
+  static void Integrate(ShipArray& ships,
+                        std::size_t begin,
+                        std::size_t end,
+                        float dt) {
+    IntegratePositions(ships.x.data() + begin, ships.y.data() + begin,
+                       ships.vx.data() + begin, ships.vy.data() + begin,
+                       end - begin, dt);
+  }
+
+  // Same behaviour as SpamShip::Update(): every kSpamPeriod a spam ship
+  // releases two small ships and a new spam ship at its position.
+  static void UpdateSpamTimers(ShipArray& spam,
+                               std::size_t begin,
+                               std::size_t end,
+                               float dt,
+                               SpawnQueue& spawns) {
+    for (std::size_t i = begin; i < end; ++i) {
+      spam.timer[i] += dt;
+      if (spam.timer[i] > kSpamPeriod) {
+        spam.timer[i] = 0;
+        const Vector2d p = spam.GetPosition(i);
+        spawns.Push(ShipType::kSmall, p, {-1, 2});
+        spawns.Push(ShipType::kSpam, p, {0, 2});
+        spawns.Push(ShipType::kSmall, p, {1, 2});
+      }
+    }
+  }
+
+  std::array<ShipArray, kShipTypeCount> ships_;
+  // Spawns of each update chunk, see Update().
+  std::vector<SpawnQueue> chunk_spawns_;
+  Pool<Rocket> rockets_;
+  // EMPs detonated since the last Update(), allocated from |arena_|.
+  std::vector<Emp*> emps_;
+  FrameArena arena_;
+  SpatialGrid grid_;
+  std::optional<Bounds> despawn_bounds_;
+};
+
+}  // namespace zt
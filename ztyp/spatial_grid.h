@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ztyp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace zt {
+
+// Uniform grid broad phase over an unbounded plane. Cells are hashed into a
+// fixed number of buckets and entries are counting-sorted by bucket on
+// Build(), so rebuilding every tick is linear and reuses its storage.
+//
+// Usage per tick: Clear(), Insert() every entity, Build(), then query.
+class SpatialGrid {
+ public:
+  explicit SpatialGrid(float cell_size = 64, std::size_t bucket_count = 4096)
+      : cell_size_(cell_size), bucket_start_(bucket_count + 1) {
+    if (cell_size <= 0 || bucket_count == 0)
+      throw std::invalid_argument("Invalid spatial grid dimensions");
+  }
+
+  void Clear() { pending_.clear(); }
+
+  void Insert(std::uint32_t id, const Vector2d& p) {
+    pending_.push_back({id, p, CellOf(p.x), CellOf(p.y)});
+  }
+
+  void Build() {
+    std::fill(bucket_start_.begin(), bucket_start_.end(), 0);
+    for (const Entry& e : pending_) {
+      ++bucket_start_[BucketOf(e.cell_x, e.cell_y) + 1];
+    }
+    for (std::size_t i = 1; i < bucket_start_.size(); ++i) {
+      bucket_start_[i] += bucket_start_[i - 1];
+    }
+
+    entries_.resize(pending_.size());
+    cursor_.assign(bucket_start_.begin(), bucket_start_.end() - 1);
+    for (const Entry& e : pending_) {
+      entries_[cursor_[BucketOf(e.cell_x, e.cell_y)]++] = e;
+    }
+  }
+
+  // Calls |f(id)| for every entry inside the rectangle [min, max].
+  template <typename F>
+  void QueryRect(const Vector2d& min, const Vector2d& max, F&& f) const {
+    ForEachCandidate(min, max, [&](const Entry& e) {
+      if (e.position.x >= min.x && e.position.x <= max.x &&
+          e.position.y >= min.y && e.position.y <= max.y) {
+        f(e.id);
+      }
+    });
+  }
+
+  // Calls |f(id)| for every entry within |radius| of |center|.
+  template <typename F>
+  void QueryRadius(const Vector2d& center, float radius, F&& f) const {
+    const float radius_sq = radius * radius;
+    ForEachCandidate({center.x - radius, center.y - radius},
+                     {center.x + radius, center.y + radius},
+                     [&](const Entry& e) {
+                       const float dx = e.position.x - center.x;
+                       const float dy = e.position.y - center.y;
+                       if (dx * dx + dy * dy <= radius_sq)
+                         f(e.id);
+                     });
+  }
+
+  std::size_t Size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    std::uint32_t id;
+    Vector2d position;
+    std::int32_t cell_x;
+    std::int32_t cell_y;
+  };
+
+  std::int32_t CellOf(float coordinate) const {
+    return static_cast<std::int32_t>(std::floor(coordinate / cell_size_));
+  }
+
+  std::size_t BucketOf(std::int32_t cell_x, std::int32_t cell_y) const {
+    const std::uint32_t hash = static_cast<std::uint32_t>(cell_x) * 73856093u ^
+                               static_cast<std::uint32_t>(cell_y) * 19349663u;
+    return hash % (bucket_start_.size() - 1);
+  }
+
+  // Entries of different cells may share a bucket, so each one is matched
+  // against the visited cell: nothing is reported twice.
+  template <typename F>
+  void ForEachCandidate(const Vector2d& min, const Vector2d& max, F&& f) const {
+    const std::int32_t x0 = CellOf(min.x);
+    const std::int32_t x1 = CellOf(max.x);
+    const std::int32_t y0 = CellOf(min.y);
+    const std::int32_t y1 = CellOf(max.y);
+    for (std::int32_t cy = y0; cy <= y1; ++cy) {
+      for (std::int32_t cx = x0; cx <= x1; ++cx) {
+        const std::size_t bucket = BucketOf(cx, cy);
+        for (std::uint32_t i = bucket_start_[bucket];
+             i < bucket_start_[bucket + 1]; ++i) {
+          const Entry& e = entries_[i];
+          if (e.cell_x == cx && e.cell_y == cy)
+            f(e);
+        }
+      }
+    }
+  }
+
+  float cell_size_;
+  std::vector<Entry> pending_;
+  std::vector<Entry> entries_;
+  std::vector<std::uint32_t> bucket_start_;
+  std::vector<std::uint32_t> cursor_;
+};
+
+}  // namespace zt
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,16 +19,90 @@ struct Vector2d {
     }
 };
 
+enum class ShipType : std::uint8_t {
+    kSmall,
+    kSpam,
+    kMother,
+};
+
+constexpr std::size_t kShipTypeCount = 3;
+
+struct SpawnCommand {
+    ShipType type;
+    Vector2d position;
+    Vector2d velocity;
+};
+
+// Ships created during an update are recorded here instead of being
+// allocated by the ship itself. The owner of the ships drains the queue after
+// the update and clears it; the storage is kept between ticks, so once it has
+// grown to the peak spawn rate a tick doesn't allocate.
+class SpawnQueue {
+    public:
+    void Push(ShipType type, const Vector2d& p, const Vector2d& v) {
+        commands_.push_back({ type, p, v });
+    }
+
+    void Reserve(std::size_t count) {
+        commands_.reserve(count);
+    }
+
+    void Clear() {
+        commands_.clear();
+    }
+
+    bool IsEmpty() const {
+        return commands_.empty();
+    }
+
+    std::size_t Size() const {
+        return commands_.size();
+    }
+
+    std::vector<SpawnCommand>::const_iterator begin() const {
+        return commands_.begin();
+    }
+
+    std::vector<SpawnCommand>::const_iterator end() const {
+        return commands_.end();
+    }
+
+    private:
+    std::vector<SpawnCommand> commands_;
+};
+
 class Weapon {
     public:
     virtual ~Weapon() {}
+
+    virtual int GetDamage() const = 0;
 };
 
+template <typename T>
+class Pool;
+class FrameArena;
+
 class Rocket : public Weapon {
     public:
+    int GetDamage() const override {
+        return 1;
+    }
+
+    void Update(float dt) {
+        position_ = position_ + velocity_ * dt;
+    }
+
+    const Vector2d& GetPosition() const {
+        return position_;
+    }
+
+    const Vector2d& GetVelocity() const {
+        return velocity_;
+    }
 
     private:
     friend class Player;
+    friend class Pool<Rocket>;
 
     Rocket(const Vector2d& p, const Vector2d& v) :
        position_(p), velocity_(v) {}
@@ -37,9 +113,25 @@ class Rocket : public Weapon {
 
 class Emp : public Weapon {
     public:
+    int GetDamage() const override {
+        return 3;
+    }
+
+    const Vector2d& GetPosition() const {
+        return position_;
+    }
+
+    float GetRadius() const {
+        return radius_;
+    }
 
     private:
     friend class Player;
+    friend class FrameArena;
+
+    Emp() = default;
+    Emp(const Vector2d& p, float radius) :
+       position_(p), radius_(radius) {}
 
     Vector2d position_;
     float radius_ = 0;
@@ -52,7 +144,7 @@ class SpaceShip {
         }
     virtual ~SpaceShip() {}
 
-    virtual std::vector<SpaceShip*> Update(float dt) = 0;
+    virtual void Update(float dt, SpawnQueue& spawns) = 0;
     virtual void Damage(Weapon* w) = 0;
 
     const std::string& GetName() const {
@@ -63,53 +155,58 @@ class SpaceShip {
         return position_;
     }
 
+    bool IsDestroyed() const {
+        return hp_ <= 0;
+    }
+
     protected:
     std::string name_;
     Vector2d position_;
     Vector2d velocity_;
+    int hp_ = 1;
 };
 
 class SmallShip : public SpaceShip {
   public:
   using SpaceShip::SpaceShip;
-  std::vector<SpaceShip*> Update(float dt) override {
+  void Update(float dt, SpawnQueue& spawns) override {
       position_ = position_ + velocity_ * dt;
-      return {};
   }
   void Damage(Weapon* w) override {
+      hp_ -= w->GetDamage();
   }
 };
 
 class MotherShip : public SpaceShip {
   public:
-  using SpaceShip::SpaceShip;
-  std::vector<SpaceShip*> Update(float dt) override {
-      return {};
+  MotherShip(const std::string& name, const Vector2d& p, const Vector2d& v) :
+      SpaceShip(name, p, v) {
+      hp_ = 10;
+  }
+  void Update(float dt, SpawnQueue& spawns) override {
   }
   void Damage(Weapon* w) override {
+      hp_ -= w->GetDamage();
   }
 };
 
 class SpamShip : public SpaceShip {
   public:
   using SpaceShip::SpaceShip;
-  std::vector<SpaceShip*> Update(float dt) override {
+  void Update(float dt, SpawnQueue& spawns) override {
       position_ = position_ + velocity_ * dt;
 
       t_ = t_ + dt;
       if (t_ > 10) {
           t_ = 0;
 
-          std::vector<SpaceShip*> result;
-          result.push_back(new SmallShip("", GetPosition(), { -1, 2 }));
-          result.push_back(new SpamShip("", GetPosition(), { 0, 2 }));
-          result.push_back(new SmallShip("", GetPosition(), { 1, 2 }));
-
-          return result;
+          spawns.Push(ShipType::kSmall, GetPosition(), { -1, 2 });
+          spawns.Push(ShipType::kSpam, GetPosition(), { 0, 2 });
+          spawns.Push(ShipType::kSmall, GetPosition(), { 1, 2 });
       }
-      return {};
   }
   void Damage(Weapon* w) override {
+      hp_ -= w->GetDamage();
   }
 
   private: